@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include "anagram_index.hpp"
+
+anagram_index::anagram_index(lexicon const& lex) {
+	std::string signature;
+	for (word_id id = 0; id < lex.size(); id++) {
+		if (lex.length(id) < MIN_WORD_LENGTH) continue;
+		signature.assign(lex.literal(id), lex.length(id));
+		std::sort(signature.begin(), signature.end());
+		by_signature[signature].push_back(id);
+	}
+
+	std::vector<std::string const*> sorted;
+	for (auto const& entry : by_signature) {
+		sorted.push_back(&entry.first);
+	}
+	std::sort(sorted.begin(), sorted.end(),
+			[] (std::string const* a, std::string const* b) { return *a < *b; });
+	for (auto s : sorted) {
+		signature_words.push_back(&by_signature.find(*s)->second);
+	}
+	build_trie(sorted, 0, sorted.size(), 0);
+}
+
+uint32_t anagram_index::build_trie(std::vector<std::string const*> const& sorted,
+		size_t first, size_t last, size_t depth) {
+	uint32_t node = nodes.size();
+	nodes.push_back(trie_node());
+	nodes[node].signature = -1;
+	// sorted puts the signature that ends here, if any, first
+	if (first < last && sorted[first]->size() == depth) {
+		nodes[node].signature = first;
+		first++;
+	}
+
+	// the rest group by their next letter; reserve the edges before recursing
+	// so that they stay contiguous
+	std::vector<size_t> group_start;
+	for (size_t i = first; i < last; i++) {
+		if (i == first || (*sorted[i])[depth] != (*sorted[i - 1])[depth]) {
+			group_start.push_back(i);
+		}
+	}
+	group_start.push_back(last);
+	nodes[node].first_edge = edges.size();
+	nodes[node].edge_count = group_start.size() - 1;
+	edges.resize(edges.size() + group_start.size() - 1);
+	for (size_t g = 0; g + 1 < group_start.size(); g++) {
+		uint32_t edge = nodes[node].first_edge + g;
+		edges[edge].letter = (*sorted[group_start[g]])[depth];
+		uint32_t child = build_trie(sorted, group_start[g], group_start[g + 1],
+				depth + 1);
+		edges[edge].node = child;
+	}
+	return node;
+}
+
+std::vector<word_id> const* anagram_index::find(
+		std::string const& signature) const {
+	auto it = by_signature.find(signature);
+	return it == by_signature.end() ? nullptr : &it->second;
+}
+
+void anagram_index::successors(std::string const& signature,
+		std::vector<word_id>& out) const {
+	std::string plus_one;
+	plus_one.reserve(signature.size() + 1);
+	for (char c = 'a'; c <= 'z'; c++) {
+		// splice c in at its sorted position
+		auto at = std::upper_bound(signature.begin(), signature.end(), c);
+		plus_one.assign(signature.begin(), at);
+		plus_one += c;
+		plus_one.append(at, signature.end());
+		auto it = by_signature.find(plus_one);
+		if (it != by_signature.end()) {
+			out.insert(out.end(), it->second.begin(), it->second.end());
+		}
+	}
+}
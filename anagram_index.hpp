@@ -0,0 +1,67 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lexicon.hpp"
+
+// maps a sorted-letter signature (word::sorted) to every game word spelled
+// with exactly those letters
+class anagram_index {
+	std::unordered_map<std::string, std::vector<word_id> > by_signature;
+
+	// a trie over the signatures' (sorted) letters, so that walking the
+	// sub-multisets of some letters visits only ones that lead to words.  A
+	// node's edges are contiguous and sorted by letter.
+	struct trie_node {
+		uint32_t first_edge;
+		uint32_t edge_count;
+		// signature ending here, numbered in sorted order, or -1
+		int32_t signature;
+	};
+	struct trie_edge {
+		char letter;
+		uint32_t node;
+	};
+	std::vector<trie_node> nodes;
+	std::vector<trie_edge> edges;
+	std::vector<std::vector<word_id> const*> signature_words;
+
+	uint32_t build_trie(std::vector<std::string const*> const& sorted,
+			size_t first, size_t last, size_t depth);
+
+	public:
+	static const uint32_t no_node = UINT32_MAX;
+
+	explicit anagram_index(lexicon const& lex);
+
+	size_t size() const { return by_signature.size(); }
+
+	// nullptr if no word has this signature
+	std::vector<word_id> const* find(std::string const& signature) const;
+
+	// appends every word that signature becomes by adding one letter, i.e. one
+	// lookup per letter a-z
+	void successors(std::string const& signature,
+			std::vector<word_id>& out) const;
+
+	uint32_t root() const { return 0; }
+	// no_node if no signature continues with c
+	uint32_t child(uint32_t node, char c) const {
+		trie_node const& n = nodes[node];
+		for (uint32_t e = n.first_edge; e < n.first_edge + n.edge_count; e++) {
+			if (edges[e].letter == c) return edges[e].node;
+			if (edges[e].letter > c) break;
+		}
+		return no_node;
+	}
+	int32_t signature_at(uint32_t node) const { return nodes[node].signature; }
+	std::vector<word_id> const& words_of(int32_t signature) const {
+		return *signature_words[signature];
+	}
+};
@@ -0,0 +1,168 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Solves every start word in valid_words.txt and writes a tab-separated table
+// of start word, best score, whether the search was exhaustive, the move cap
+// it searched under (0 for none), words searched, depth and positions
+// searched.  An exhaustive search's score is the best within the move cap,
+// and only with no cap the best there is.  Words searched is left empty for
+// a search cut short, where it only counts what the budget happened to
+// reach.  Start words are shared out over threads, one search each.  The
+// table is its own checkpoint: rows are appended and synced as words finish,
+// and a rerun skips the words already in it.
+// usage: analyze <table> [max nodes] [seconds] [threads] [table MB]
+//                [max moves]
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "anagram_index.hpp"
+#include "engine.hpp"
+#include "lexicon.hpp"
+#include "solver.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+
+// per start word.  Deep positions hold dozens of words, each with splits that
+// take milliseconds to list, so unlimited games never finish on the full
+// lexicon.
+#define ANALYZE_SECONDS 60
+#define ANALYZE_MAX_MOVES 10
+#define ANALYZE_TABLE_MB 16
+
+#define ANALYZE_HEADER "start\tscore\texhaustive\tmax_moves\twords_searched" \
+	"\tdepth\tpositions\n"
+
+// the start words already in the table, after its header.  A run killed
+// mid-write can leave a partial last row, which is cut off so it's redone.
+static std::set<std::string> finished(char const* path) {
+	std::set<std::string> done;
+	std::ifstream in(path, std::ios::binary);
+	if (!in) return done;
+	std::string contents((std::istreambuf_iterator<char>(in)),
+			std::istreambuf_iterator<char>());
+	size_t end = contents.rfind('\n');
+	end = end == std::string::npos ? 0 : end + 1;
+	if (end != contents.size() && truncate(path, end) != 0) {
+		throw std::runtime_error(std::string("Couldn't truncate ") + path + ".");
+	}
+	for (size_t line = contents.find('\n') + 1; line < end; ) {
+		size_t eol = contents.find('\n', line);
+		done.insert(contents.substr(line, contents.find('\t', line) - line));
+		line = eol + 1;
+	}
+	return done;
+}
+
+int main(int argc, char** argv) try {
+	if (argc < 2 || argc > 7) {
+		fprintf(stderr, "usage: %s <table> [max nodes] [seconds] [threads] "
+				"[table MB] [max moves]\n", argv[0]);
+		return 2;
+	}
+	char const* path = argv[1];
+	solver_options options;
+	if (argc > 2) options.max_nodes = strtoull(argv[2], nullptr, 10);
+	options.time_limit = argc > 3 ? atof(argv[3]) : ANALYZE_SECONDS;
+	unsigned threads = argc > 4 ? atoi(argv[4]) :
+		std::thread::hardware_concurrency();
+	options.table_bytes = (argc > 5 ? strtoull(argv[5], nullptr, 10) :
+			ANALYZE_TABLE_MB) << 20;
+	options.max_moves = argc > 6 ? atoi(argv[6]) : ANALYZE_MAX_MOVES;
+	// the parallelism is across start words, not within a search
+	options.threads = 1;
+
+	lexicon lex(LEXICON_SNAPSHOT);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	anagram_index index(lex);
+	successor_graph graph(lex, SUCCESSORS_SNAPSHOT);
+	std::unique_ptr<bound_table> bounds;
+	if (access(BOUNDS_SNAPSHOT, R_OK) == 0) {
+		bounds.reset(new bound_table(lex, BOUNDS_SNAPSHOT));
+	}
+	if (threads == 0 || !stems.is_baked()) threads = 1;
+
+	std::set<std::string> done = finished(path);
+	std::vector<std::string> todo;
+	for (auto const& start : read_start_words()) {
+		if (!done.count(start)) todo.push_back(start);
+	}
+	FILE* table = fopen(path, "a");
+	if (!table) {
+		throw std::runtime_error(std::string("Couldn't open ") + path + ".");
+	}
+	fseek(table, 0, SEEK_END);
+	if (ftell(table) == 0) fputs(ANALYZE_HEADER, table);
+
+	solver s(lex, index, graph, stems, bounds.get());
+	std::atomic<size_t> next(0);
+	std::mutex table_lock;
+	// rows written, and start words tried, written or not
+	size_t written = 0, tried = 0;
+	auto work = [&] () {
+		for (size_t i = next++; i < todo.size(); i = next++) {
+			std::string row;
+			try {
+				solution best = s.solve(todo[i], options);
+				char words[32] = "";
+				if (best.complete) {
+					snprintf(words, sizeof(words), "%lu",
+							static_cast<unsigned long>(best.reachable));
+				}
+				char buf[128];
+				snprintf(buf, sizeof(buf), "\t%lu\t%d\t%u\t%s\t%lu\t%llu\n",
+						best.score, best.complete ? 1 : 0, options.max_moves,
+						words, static_cast<unsigned long>(best.depth),
+						static_cast<unsigned long long>(best.nodes));
+				row = best.start + buf;
+			} catch (std::exception& e) {
+				// a start word the lexicon has lost; the rest are still worth
+				// having
+				std::lock_guard<std::mutex> hold(table_lock);
+				fprintf(stderr, "\r%s\n", e.what());
+				tried++;
+				continue;
+			}
+			// synced row by row, so a crash loses at most the searches under way
+			std::lock_guard<std::mutex> hold(table_lock);
+			fputs(row.c_str(), table);
+			fflush(table);
+			fsync(fileno(table));
+			written++;
+			tried++;
+			fprintf(stderr, "\r%lu/%lu", static_cast<unsigned long>(tried),
+					static_cast<unsigned long>(todo.size()));
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < threads; i++) {
+		pool.emplace_back(work);
+	}
+	work();
+	for (auto& t : pool) {
+		t.join();
+	}
+	fclose(table);
+
+	fprintf(stderr, "%s%s: %lu start words, %lu already done\n",
+			tried ? "\n" : "", path,
+			static_cast<unsigned long>(done.size() + written),
+			static_cast<unsigned long>(done.size()));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Plays a whole game from a start word, taking the move Monte Carlo tree
+// search favours each turn, and prints the moves and the final score.
+// usage: autoplay <start word|random> [seconds per move] [threads]
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "lexicon.hpp"
+#include "mcts.hpp"
+#include "stem_source.hpp"
+
+int main(int argc, char** argv) try {
+	if (argc < 2 || argc > 4) {
+		fprintf(stderr, "usage: %s <start word|random> [seconds per move] "
+				"[threads]\n", argv[0]);
+		return 2;
+	}
+	std::string start = argv[1];
+	if (start == "r" || start == "random") {
+		std::vector<std::string> choices = read_start_words();
+		start = choices[std::random_device()()%choices.size()];
+	}
+	mcts_options options;
+	if (argc > 2) options.time_limit = atof(argv[2]);
+	if (argc > 3) options.threads = atoi(argv[3]);
+
+	lexicon lex(LEXICON_SNAPSHOT);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	game_state state = rules.new_game();
+	if (!rules.start(state, start)) {
+		throw std::runtime_error("'" + start + "' is not a valid start word.");
+	}
+
+	uint64_t playouts = 0;
+	for (;;) {
+		mcts_advice advice = rules.advise(state, options);
+		if (!advice.found) break;
+		playouts += advice.playouts;
+		std::string text = move_text(lex, advice.best);
+		move_result result = rules.apply_move(state, text.c_str());
+		if (result.status != move_status::ok) {
+			throw std::runtime_error("The engine rejected '" + text + "'.");
+		}
+		printf("%s (+%lu, %.0f playouts/s)\n", text.c_str(), result.points,
+				advice.playouts_per_second);
+	}
+	printf("%s: %lu (%llu playouts)\n", start.c_str(),
+			rules.final_score(state), static_cast<unsigned long long>(playouts));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
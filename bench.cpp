@@ -0,0 +1,685 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Benchmarks for the game's hot paths and start-up costs.  Each result is one
+// JSON line on stdout.
+// usage: bench [name filter]
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ncurses.h>
+#include <unistd.h>
+
+#include "anagram_index.hpp"
+#include "bench.hpp"
+#include "engine.hpp"
+#include "game_history.hpp"
+#include "journal.hpp"
+#include "lexicon.hpp"
+#include "mcts.hpp"
+#include "morphology.hpp"
+#include "paginate.hpp"
+#include "saved_game.hpp"
+#include "solver.hpp"
+#include "spell_pool.hpp"
+#include "stem_source.hpp"
+#include "stemmer.hpp"
+#include "successor_graph.hpp"
+#include "word_set.hpp"
+
+#define BENCH_GAMES "bench_games.txt"
+// most moves in each journal replayed
+#define BENCH_JOURNAL_MOVES 200
+// words held by a game in the container benchmarks
+#define BENCH_GAME_WORDS 40
+// positions searched from each start word per solver run
+#define BENCH_SOLVER_NODES 4000
+// playouts from each start word per MCTS run
+#define BENCH_MCTS_PLAYOUTS 500
+
+std::atomic<uint64_t> bench_allocations(0);
+
+void* operator new(size_t size) {
+	bench_allocations++;
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+static std::string name_filter;
+
+static bool wanted(std::string const& name) {
+	return name.find(name_filter) != std::string::npos;
+}
+
+// the game words of the lexicon, in a fixed shuffled order
+static std::vector<std::string> sample_words(lexicon const& lex, size_t n) {
+	std::vector<std::string> words;
+	for (word_id id = 0; id < lex.size() && words.size() < n;
+			id += 7) {
+		if (lex.length(id) >= MIN_WORD_LENGTH) words.push_back(lex.literal(id));
+	}
+	return words;
+}
+
+static void bench_init() {
+	if (wanted("init/lexicon")) {
+		report(run_bench("init/lexicon", 1, 20, [] () {
+			lexicon lex(LEXICON_SNAPSHOT);
+			return lex.size();
+		}));
+	}
+	if (wanted("init/hunspell")) {
+		report(run_bench("init/hunspell", 1, 3, [] () {
+			Hunspell spell(HUNSPELL_AFF, HUNSPELL_DIC);
+			return spell.spell("rat");
+		}));
+	}
+	if (wanted("init/morphology")) {
+		try {
+			report(run_bench("init/morphology", 1, 3, [] () {
+				morphology morph;
+				return morph.defined("rat", noun);
+			}));
+		} catch (std::exception& e) {
+			fprintf(stderr, "skipping init/morphology: %s\n", e.what());
+		}
+	}
+	if (wanted("init/initscr")) {
+		FILE* devnull = fopen("/dev/null", "w");
+		report(run_bench("init/initscr", 1, 1, [devnull] () {
+			SCREEN* screen = newterm(nullptr, devnull, stdin);
+			if (screen == nullptr) return 0;
+			endwin();
+			delscreen(screen);
+			return 1;
+		}));
+		fclose(devnull);
+	}
+}
+
+static void bench_words(lexicon const& lex) {
+	std::vector<std::string> words = sample_words(lex, 4096);
+	if (wanted("word/construct")) {
+		report(run_bench("word/construct", words.size(), 200, [&] () {
+			size_t n = 0;
+			for (auto const& w : words) {
+				n += word(w).sorted.size();
+			}
+			return n;
+		}));
+	}
+	if (wanted("word/is_one_less_than")) {
+		std::vector<word> smaller;
+		std::vector<letter_histogram> bigger;
+		for (auto const& w : words) {
+			smaller.emplace_back(w);
+			std::string plus = w + "e";
+			bigger.emplace_back(plus.data(), plus.size());
+		}
+		report(run_bench("word/is_one_less_than", words.size(), 1000, [&] () {
+			size_t n = 0;
+			for (size_t i = 0; i < smaller.size(); i++) {
+				n += smaller[i].is_one_less_than(bigger[(i * 31) % bigger.size()]);
+				n += smaller[i].is_one_less_than(bigger[i]);
+			}
+			return n;
+		}));
+	}
+	if (wanted("paginate")) {
+		word_set from;
+		for (auto const& w : words) {
+			from.insert(lex.find(w));
+		}
+		std::vector<std::array<std::string, 15> > to;
+		report(run_bench("paginate/4096", 1, 200, [&] () {
+			paginate(lex, from, to);
+			return to.size();
+		}));
+	}
+}
+
+// game state containers, std::set<word> as game_state once held them against
+// word_set, on games of BENCH_GAME_WORDS words.  play swaps every word out
+// for another, as apply_move does; copy is what a saved or searched state
+// costs; iterate walks the words as paginate and final_score do.
+static void bench_containers(lexicon const& lex) {
+	if (!wanted("containers")) return;
+	std::vector<std::string> words = sample_words(lex, 2 * BENCH_GAME_WORDS);
+	std::vector<word_id> ids;
+	for (auto const& w : words) {
+		ids.push_back(lex.find(w));
+	}
+	size_t half = words.size() / 2;
+
+	std::set<word> set_game(words.begin(), words.begin() + half);
+	report(run_bench("containers/set/play", half, 2000, [&] () {
+		std::set<word> g = set_game;
+		for (size_t i = 0; i < half; i++) {
+			g.erase(g.find(word(words[i])));
+			g.insert(word(words[half + i]));
+		}
+		return g.size();
+	}));
+	report(run_bench("containers/set/copy", 1, 20000, [&] () {
+		std::set<word> g = set_game;
+		return g.size();
+	}));
+	report(run_bench("containers/set/iterate", half, 20000, [&] () {
+		size_t n = 0;
+		for (auto const& w : set_game) {
+			n += w.literal.size() - 3;
+		}
+		return n;
+	}));
+
+	word_set flat_game;
+	flat_game.insert(ids.begin(), ids.begin() + half);
+	report(run_bench("containers/word_set/play", half, 2000, [&] () {
+		word_set g = flat_game;
+		for (size_t i = 0; i < half; i++) {
+			g.erase(g.find(ids[i]));
+			g.insert(ids[half + i]);
+		}
+		return g.size();
+	}));
+	report(run_bench("containers/word_set/copy", 1, 20000, [&] () {
+		word_set g = flat_game;
+		return g.size();
+	}));
+	report(run_bench("containers/word_set/iterate", half, 20000, [&] () {
+		size_t n = 0;
+		for (word_id id : flat_game) {
+			n += lex.length(id) - 3;
+		}
+		return n;
+	}));
+}
+
+static void bench_stems(lexicon const& lex) {
+	std::vector<std::string> words = sample_words(lex, 4096);
+	if (wanted("stems/baked")) {
+		stem_source stems(lex, STEMS_SNAPSHOT);
+		if (stems.is_baked()) {
+			report(run_bench("stems/baked", words.size(), 200, [&] () {
+				size_t n = 0;
+				for (auto const& w : words) {
+					n += stems.stems(w).size();
+				}
+				return n;
+			}));
+		}
+	}
+	if (wanted("stems/live")) {
+		// an unreadable table path forces the live stemmer
+		std::unique_ptr<stem_source> stems;
+		try {
+			stems.reset(new stem_source(lex, ""));
+		} catch (std::exception& e) {
+			fprintf(stderr, "skipping stems/live: %s\n", e.what());
+			return;
+		}
+		stems->cache().set_enabled(false);
+		report(run_bench("stems/live/uncached", words.size(), 3, [&] () {
+			size_t n = 0;
+			for (auto const& w : words) {
+				n += stems->stems(w).size();
+			}
+			return n;
+		}));
+		stems->cache().set_enabled(true);
+		bench_result r = run_bench("stems/live/cached", words.size(), 20, [&] () {
+			size_t n = 0;
+			for (auto const& w : words) {
+				n += stems->stems(w).size();
+			}
+			return n;
+		});
+		report(r);
+		fprintf(stderr, "stems/live/cached: hit rate %.3f\n",
+				stems->cache().hit_rate());
+	}
+}
+
+// every game word and as many misspellings, checked on more and more threads
+// by Hunspell, each with a handle from the pool, and by the lexicon snapshot
+// that all threads share
+static void bench_validate(lexicon const& lex) {
+	if (!wanted("validate")) return;
+	std::vector<std::string> words;
+	for (word_id id = 0; id < lex.size(); id++) {
+		if (lex.length(id) < MIN_WORD_LENGTH) continue;
+		std::string w = lex.literal(id);
+		words.push_back(w);
+		words.push_back(w + "qx");
+	}
+	unsigned cores = std::thread::hardware_concurrency();
+	std::vector<unsigned> thread_counts;
+	for (unsigned n = 1; n <= std::max(2u, cores); n *= 2) {
+		thread_counts.push_back(n);
+	}
+
+	if (wanted("validate/hunspell")) {
+		spell_pool pool;
+		// handles load outside the timing; init/hunspell has their cost
+		pool.reserve(thread_counts.back());
+		for (unsigned n : thread_counts) {
+			std::string name = "validate/hunspell/" + std::to_string(n) +
+				"_threads";
+			bench_result r = run_bench(name, words.size(), 3, [&] () {
+				std::vector<char> right = pool.check(words, n);
+				return std::count(right.begin(), right.end(), 1);
+			});
+			report(r);
+			fprintf(stderr, "%s: %.0f words/s\n", name.c_str(), 1e9 / r.ns_per_op);
+		}
+	}
+	if (wanted("validate/lexicon")) {
+		for (unsigned n : thread_counts) {
+			std::string name = "validate/lexicon/" + std::to_string(n) +
+				"_threads";
+			bench_result r = run_bench(name, words.size(), 20, [&] () {
+				std::atomic<size_t> right(0);
+				std::vector<std::thread> threads;
+				for (unsigned t = 0; t < n; t++) {
+					threads.emplace_back([&, t] () {
+						size_t mine = 0;
+						for (size_t i = t; i < words.size(); i += n) {
+							mine += lex.contains(words[i]);
+						}
+						right += mine;
+					});
+				}
+				for (auto& t : threads) {
+					t.join();
+				}
+				return right.load();
+			});
+			report(r);
+			fprintf(stderr, "%s: %.0f words/s\n", name.c_str(), 1e9 / r.ns_per_op);
+		}
+	}
+}
+
+// base forms of game words as every part of speech, on more and more threads
+// sharing one morphology
+static void bench_morphology(lexicon const& lex) {
+	if (!wanted("morphology")) return;
+	std::unique_ptr<morphology> morph;
+	try {
+		morph.reset(new morphology());
+	} catch (std::exception& e) {
+		fprintf(stderr, "skipping morphology: %s\n", e.what());
+		return;
+	}
+	std::vector<std::string> words = sample_words(lex, 16384);
+	unsigned cores = std::thread::hardware_concurrency();
+	for (unsigned n = 1; n <= std::max(2u, cores); n *= 2) {
+		std::string name = "morphology/" + std::to_string(n) + "_threads";
+		bench_result r = run_bench(name, words.size() * parts_of_speech, 20,
+				[&] () {
+			std::atomic<size_t> found(0);
+			std::vector<std::thread> threads;
+			for (unsigned t = 0; t < n; t++) {
+				threads.emplace_back([&, t] () {
+					size_t mine = 0;
+					std::string base;
+					for (size_t i = t; i < words.size(); i += n) {
+						for (int pos = noun; pos < parts_of_speech; pos++) {
+							mine += morph->base_form(words[i],
+									static_cast<part_of_speech>(pos), base);
+						}
+					}
+					found += mine;
+				});
+			}
+			for (auto& t : threads) {
+				t.join();
+			}
+			return found.load();
+		});
+		report(r);
+		fprintf(stderr, "%s: %.0f lookups/s\n", name.c_str(), 1e9 / r.ns_per_op);
+	}
+}
+
+static void bench_anagram_index(lexicon const& lex) {
+	if (!wanted("anagram_index")) return;
+	report(run_bench("anagram_index/build", 1, 3, [&] () {
+		return anagram_index(lex).size();
+	}));
+
+	anagram_index index(lex);
+	std::vector<std::string> signatures;
+	for (auto const& w : sample_words(lex, 4096)) {
+		std::string s = w;
+		std::sort(s.begin(), s.end());
+		signatures.push_back(s);
+	}
+	std::vector<word_id> out;
+	// each query is 26 hash lookups
+	report(run_bench("anagram_index/successors", signatures.size(), 50, [&] () {
+		size_t n = 0;
+		for (auto const& s : signatures) {
+			out.clear();
+			index.successors(s, out);
+			n += out.size();
+		}
+		return n;
+	}));
+}
+
+static void bench_replay(lexicon const& lex) {
+	if (!wanted("game/replay")) return;
+	std::vector<scripted_game> games = read_games(BENCH_GAMES);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	size_t moves = 0;
+	for (auto const& g : games) {
+		moves += g.moves.size();
+	}
+	report(run_bench("game/replay", moves, 2000, [&] () {
+		unsigned long total = 0;
+		for (auto const& g : games) {
+			game_state state = rules.new_game();
+			rules.start(state, g.start);
+			for (auto const& m : g.moves) {
+				rules.apply_move(state, m.c_str());
+			}
+			total += rules.final_score(state);
+		}
+		return total;
+	}));
+}
+
+// each move of the scripted games against the state it was typed in, rejected
+// ones included: parsing alone, then parsing and checking against the rules
+static void bench_moves(lexicon const& lex) {
+	if (!wanted("move/")) return;
+	std::vector<scripted_game> games = read_games(BENCH_GAMES);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	std::vector<game_state> states;
+	std::vector<std::string> inputs;
+	for (auto const& g : games) {
+		game_state state = rules.new_game();
+		rules.start(state, g.start);
+		for (auto const& m : g.moves) {
+			states.push_back(state);
+			inputs.push_back(m);
+			rules.apply_move(state, m.c_str());
+		}
+	}
+	parsed_move parsed;
+	report(run_bench("move/parse", inputs.size(), 20000, [&] () {
+		size_t n = 0;
+		for (auto const& input : inputs) {
+			n += parse_move(input.c_str(), parsed) + parsed.word_count;
+		}
+		return n;
+	}));
+	game_move m;
+	report(run_bench("move/parse_check", inputs.size(), 5000, [&] () {
+		size_t n = 0;
+		for (size_t i = 0; i < inputs.size(); i++) {
+			n += static_cast<size_t>(rules.check_move(states[i],
+						inputs[i].c_str(), m).status);
+		}
+		return n;
+	}));
+}
+
+// the scripted games again, keeping each move's changes for undo; then
+// undoing and redoing whole games, which costs a snapshot copy and at most
+// HISTORY_SNAPSHOT_MOVES moves' changes whatever their length
+static void bench_history(lexicon const& lex) {
+	if (!wanted("history")) return;
+	std::vector<scripted_game> games = read_games(BENCH_GAMES);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	size_t moves = 0;
+	for (auto const& g : games) {
+		moves += g.moves.size();
+	}
+	std::vector<game_history> played;
+	report(run_bench("history/record", moves, 2000, [&] () {
+		played.clear();
+		for (auto const& g : games) {
+			game_state state = rules.new_game();
+			rules.start(state, g.start);
+			game_history history(state);
+			for (auto const& m : g.moves) {
+				if (rules.apply_move(state, m.c_str()).status == move_status::ok) {
+					history.push(state);
+				}
+			}
+			played.push_back(history);
+		}
+		return played.size();
+	}));
+	report(run_bench("history/undo_all", played.size(), 20000, [&] () {
+		size_t n = 0;
+		for (auto& history : played) {
+			n += history.undo(history.moves());
+			n += history.redo(history.undone());
+			n += history.state().score;
+		}
+		return n;
+	}));
+}
+
+// saving and resuming a game with a third of the lexicon in prior, far longer
+// than any real game; load is the mapping plus rebuilding game_state
+static void bench_save(lexicon const& lex) {
+	if (!wanted("save")) return;
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	game_state state = rules.new_game();
+	for (word_id id = 0; id < lex.size(); id++) {
+		stem_range s = stems.stems(id);
+		if (id % 3 == 0) {
+			state.prior.insert(id);
+			state.used_stems.insert(s.begin(), s.end());
+		} else if (id % 1000 == 1) {
+			state.current.insert(id);
+			state.used_stems.insert(s.begin(), s.end());
+		}
+	}
+	fprintf(stderr, "save: %lu prior words, %lu used stems\n",
+			static_cast<unsigned long>(state.prior.size()),
+			static_cast<unsigned long>(state.used_stems.size()));
+	char const* path = "bench.sav";
+	report(run_bench("save/write", 1, 200, [&] () {
+		saved_game::write(lex, stems, state, 0, 0, path);
+		return 1;
+	}));
+	report(run_bench("save/load", 1, 200, [&] () {
+		saved_game saved(lex, path);
+		return saved.state(rules).prior.size();
+	}));
+	unlink(path);
+}
+
+// journals of long games, each move the best scoring hint, replayed by ID;
+// compare game/replay, which parses every move
+static void bench_journal(lexicon const& lex) {
+	if (!wanted("journal/replay")) return;
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	std::vector<std::unique_ptr<journal_reader> > journals;
+	std::vector<game_move> moves;
+	size_t total = 0;
+	for (char const* start : { "ate", "ear", "rat" }) {
+		std::string path = std::string("bench-") + start + ".jnl";
+		game_state state = rules.new_game();
+		rules.start(state, start);
+		{
+			journal_writer journal(lex, state, path.c_str());
+			for (int i = 0; i < BENCH_JOURNAL_MOVES; i++) {
+				rules.hints(state, moves);
+				if (moves.empty()) break;
+				rules.apply_move(state, moves.front());
+				journal.move(moves.front());
+				total++;
+			}
+		}
+		journals.emplace_back(new journal_reader(lex, path.c_str()));
+		unlink(path.c_str());
+	}
+	report(run_bench("journal/replay", total, 200, [&] () {
+		unsigned long score = 0;
+		for (auto const& j : journals) {
+			score += j->replay(rules).state.score;
+		}
+		return score;
+	}));
+}
+
+// hints for positions with a few dozen current words, reached by always
+// taking the move that splits into the most words
+static void bench_hints(lexicon const& lex) {
+	if (!wanted("engine/hints")) return;
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	std::vector<game_state> positions;
+	std::vector<game_move> moves;
+	for (char const* start : { "ate", "ear", "rat" }) {
+		game_state state = rules.new_game();
+		rules.start(state, start);
+		for (int i = 0; i < 100; i++) {
+			rules.hints(state, moves);
+			if (moves.empty()) break;
+			auto widest = std::max_element(moves.begin(), moves.end(),
+					[] (game_move const& a, game_move const& b) {
+						return a.words.size() < b.words.size();
+					});
+			rules.apply_move(state, move_text(lex, *widest).c_str());
+		}
+		fprintf(stderr, "engine/hints: %s reaches %lu current words\n", start,
+				static_cast<unsigned long>(state.current.size()));
+		positions.push_back(state);
+	}
+	report(run_bench("engine/hints", positions.size(), 50, [&] () {
+		size_t n = 0;
+		for (auto const& state : positions) {
+			rules.hints(state, moves);
+			n += moves.size();
+		}
+		return n;
+	}));
+}
+
+// searches a fixed number of positions from some rich start words, at 1, 2,
+// 4... threads up to one per core; ns_per_op is per position, so perfect
+// scaling halves it at each step
+static void bench_solver(lexicon const& lex) {
+	if (!wanted("solver")) return;
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	if (!stems.is_baked()) {
+		fprintf(stderr, "skipping solver: parallel search needs baked stems\n");
+		return;
+	}
+	anagram_index index(lex);
+	successor_graph graph(lex, SUCCESSORS_SNAPSHOT);
+	char const* starts[] = { "ate", "ear", "rat", "tea" };
+	size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t threads = 1; ; threads *= 2) {
+		threads = std::min(threads, cores);
+		solver_options options;
+		options.max_nodes = BENCH_SOLVER_NODES;
+		options.threads = threads;
+		uint64_t nodes = 0;
+		std::string name = "solver/threads/" + std::to_string(threads);
+		bench_result r = run_bench(name, 1, 1, [&] () {
+			solver s(lex, index, graph, stems);
+			unsigned long total = 0;
+			for (char const* start : starts) {
+				solution best = s.solve(start, options);
+				nodes += best.nodes;
+				total += best.score;
+			}
+			return total;
+		});
+		// the workers overshoot the budget a little, so count what they did
+		r.ns_per_op *= static_cast<double>(r.ops) / nodes;
+		r.allocs_per_op *= static_cast<double>(r.ops) / nodes;
+		// one run, so no percentiles
+		r.samples = 1;
+		r.ops = nodes;
+		report(r);
+		if (threads == cores) break;
+	}
+}
+
+// playouts from some start words at 1, 2, 4... threads up to one per core;
+// ns_per_op is per playout
+static void bench_mcts(lexicon const& lex) {
+	if (!wanted("mcts")) return;
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	if (!stems.is_baked()) {
+		fprintf(stderr, "skipping mcts: parallel search needs baked stems\n");
+		return;
+	}
+	engine rules(lex, stems);
+	std::vector<game_state> starts;
+	for (char const* start : { "ate", "ear", "rat", "tea" }) {
+		starts.push_back(rules.new_game());
+		rules.start(starts.back(), start);
+	}
+	size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	for (size_t threads = 1; ; threads *= 2) {
+		threads = std::min(threads, cores);
+		mcts_options options;
+		options.time_limit = 0;
+		options.max_playouts = BENCH_MCTS_PLAYOUTS;
+		options.threads = threads;
+		options.seed = 1;
+		std::string name = "mcts/threads/" + std::to_string(threads);
+		report(run_bench(name, BENCH_MCTS_PLAYOUTS * starts.size(), 1, [&] () {
+			double total = 0;
+			for (auto const& state : starts) {
+				total += rules.advise(state, options).mean_score;
+			}
+			return static_cast<uint64_t>(total);
+		}));
+		if (threads == cores) break;
+	}
+}
+
+int main(int argc, char** argv) try {
+	if (argc > 1) name_filter = argv[1];
+	bench_init();
+	lexicon lex(LEXICON_SNAPSHOT);
+	bench_words(lex);
+	bench_containers(lex);
+	bench_anagram_index(lex);
+	bench_stems(lex);
+	bench_validate(lex);
+	bench_morphology(lex);
+	bench_replay(lex);
+	bench_moves(lex);
+	bench_history(lex);
+	bench_save(lex);
+	bench_journal(lex);
+	bench_hints(lex);
+	bench_solver(lex);
+	bench_mcts(lex);
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
@@ -0,0 +1,124 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// incremented by the bench program's replacement operator new
+extern std::atomic<uint64_t> bench_allocations;
+
+typedef std::chrono::steady_clock bench_clock;
+
+// fewest timing samples percentiles are reported from; with fewer, p99 would
+// just be the slowest sample
+#define BENCH_MIN_SAMPLES 100
+
+inline double seconds_since(bench_clock::time_point start) {
+	return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+struct bench_result {
+	std::string name;
+	uint64_t ops;
+	double ns_per_op;
+	double allocs_per_op;
+	// percentiles of the time samples taken, per op.  A sample is one batch's
+	// mean, so it is a single op's latency only where batches are one op.
+	size_t samples;
+	double p50;
+	double p90;
+	double p99;
+	double max;
+};
+
+// one JSON object per line on stdout, so runs can be diffed and compared.
+// Percentiles are null where there were too few samples to mean anything.
+inline void report(bench_result const& r) {
+	char percentiles[160];
+	if (r.samples >= BENCH_MIN_SAMPLES) {
+		snprintf(percentiles, sizeof(percentiles), "\"p50_ns\":%.2f,"
+				"\"p90_ns\":%.2f,\"p99_ns\":%.2f,\"max_ns\":%.2f",
+				r.p50, r.p90, r.p99, r.max);
+	} else {
+		snprintf(percentiles, sizeof(percentiles), "\"p50_ns\":null,"
+				"\"p90_ns\":null,\"p99_ns\":null,\"max_ns\":null");
+	}
+	printf("{\"name\":\"%s\",\"ops\":%llu,\"ns_per_op\":%.2f,"
+			"\"allocs_per_op\":%.3f,\"samples\":%llu,%s}\n", r.name.c_str(),
+			static_cast<unsigned long long>(r.ops), r.ns_per_op, r.allocs_per_op,
+			static_cast<unsigned long long>(r.samples), percentiles);
+	fflush(stdout);
+}
+
+// times batches calls of f(), each doing batch_size ops, and reports per-op
+// figures.  f returns something derived from its work so it isn't optimised
+// away.
+template<typename F> bench_result run_bench(std::string const& name,
+		size_t batch_size, size_t batches, F f) {
+	std::vector<double> per_op;
+	per_op.reserve(batches);
+	uint64_t sink = 0;
+	uint64_t allocations = bench_allocations.load();
+	bench_clock::time_point start = bench_clock::now();
+	for (size_t i = 0; i < batches; i++) {
+		bench_clock::time_point batch_start = bench_clock::now();
+		sink += f();
+		per_op.push_back(seconds_since(batch_start) * 1e9 / batch_size);
+	}
+	double elapsed = seconds_since(start);
+	allocations = bench_allocations.load() - allocations;
+	// keep sink alive without printing it
+	if (sink == 0xdeadbeef) fputc('\0', stderr);
+
+	bench_result r;
+	r.name = name;
+	r.ops = batch_size * batches;
+	r.ns_per_op = elapsed * 1e9 / r.ops;
+	// the per_op vector's own storage was allocated before counting began
+	r.allocs_per_op = static_cast<double>(allocations) / r.ops;
+	std::sort(per_op.begin(), per_op.end());
+	r.samples = per_op.size();
+	r.p50 = per_op[per_op.size() / 2];
+	r.p90 = per_op[per_op.size() * 9 / 10];
+	r.p99 = per_op[per_op.size() * 99 / 100];
+	r.max = per_op.back();
+	return r;
+}
+
+struct scripted_game {
+	std::string start;
+	std::vector<std::string> moves;
+};
+
+// games in the format of bench_games.txt
+inline std::vector<scripted_game> read_games(char const* path) {
+	std::ifstream in(path);
+	if (!in) {
+		throw std::runtime_error(std::string("Couldn't read ") + path + ".");
+	}
+	std::vector<scripted_game> games;
+	bool in_game = false;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line[0] == '#') continue;
+		if (line.empty()) {
+			in_game = false;
+		} else if (!in_game) {
+			games.emplace_back();
+			games.back().start = line;
+			in_game = true;
+		} else {
+			games.back().moves.push_back(line);
+		}
+	}
+	return games;
+}
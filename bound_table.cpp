@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "bound_table.hpp"
+
+bound_table::bound_table(lexicon const& lex, char const* path) : file(path) {
+	if (file.size() < sizeof(bounds_header)) {
+		throw std::runtime_error("Bound snapshot is truncated.");
+	}
+	header = reinterpret_cast<bounds_header const*>(file.data());
+	if (memcmp(header->magic, BOUNDS_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a bound snapshot.");
+	}
+	if (header->version != BOUNDS_VERSION ||
+			header->word_count != lex.size()) {
+		throw std::runtime_error(
+				"Bound snapshot doesn't match the lexicon; rebuild it.");
+	}
+	if (file.size() != sizeof(bounds_header) + static_cast<size_t>(
+				header->word_count) * (header->layers + 1) * sizeof(uint16_t)) {
+		throw std::runtime_error("Bound snapshot is truncated.");
+	}
+	values = reinterpret_cast<uint16_t const*>(file.data() +
+			sizeof(bounds_header));
+}
+
+void bound_table::write_snapshot(std::vector<uint16_t> const& values,
+		uint32_t word_count, uint32_t layers, char const* path) {
+	if (values.size() != static_cast<size_t>(word_count) * (layers + 1)) {
+		throw std::runtime_error("Bound table has the wrong shape.");
+	}
+	bounds_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BOUNDS_MAGIC, sizeof(h.magic));
+	h.version = BOUNDS_VERSION;
+	h.word_count = word_count;
+	h.layers = layers;
+
+	std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+	out.append(reinterpret_cast<char const*>(values.data()),
+			values.size() * sizeof(uint16_t));
+	write_file_atomic(path, out.data(), out.size());
+}
@@ -0,0 +1,53 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "mapped_file.hpp"
+
+#define BOUNDS_SNAPSHOT "bounds.bin"
+#define BOUNDS_MAGIC "RTP-BND"
+#define BOUNDS_VERSION 1
+// how many moves ahead build_bounds looks by default
+#define BOUNDS_LAYERS 64
+
+// on-disk layout: header, then for each word layers + 1 bounds, one per move
+// budget from 0 to layers
+struct bounds_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+	uint32_t layers;
+	uint32_t reserved;
+};
+
+// for each lexicon word and each move budget, an upper bound on what that word
+// alone can add to the final score in that many moves: the points of the
+// words it turns into, plus the length-3 bonus of those still current at the
+// end.  Stems are ignored and split parts are treated as the best word of
+// their length, so the bounds are loose but never too low.  Without a move
+// budget there's no bound at all: a split's parts can grow back into the word
+// they came from.  Mapped from build_bounds' snapshot.
+class bound_table {
+	mapped_file file;
+	bounds_header const* header;
+	uint16_t const* values;
+
+	public:
+	bound_table(lexicon const& lex, char const* path = BOUNDS_SNAPSHOT);
+
+	// the largest move budget with a bound
+	unsigned layers() const { return header->layers; }
+	// moves must be at most layers()
+	unsigned bound(word_id id, unsigned moves) const {
+		return values[static_cast<size_t>(id) * (header->layers + 1) + moves];
+	}
+
+	// values holds layers + 1 bounds per word, word by word
+	static void write_snapshot(std::vector<uint16_t> const& values,
+			uint32_t word_count, uint32_t layers, char const* path);
+};
@@ -0,0 +1,153 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Computes every word's score bound for each move budget and writes them as a
+// bound table snapshot.  Budget r's bounds need only budget r - 1's and
+// below, so the table is built one budget at a time, each spread over
+// threads.
+// usage: build_bounds <lexicon> <successors> <snapshot> [layers] [threads]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "bound_table.hpp"
+#include "lexicon.hpp"
+#include "successor_graph.hpp"
+
+typedef std::chrono::steady_clock build_clock;
+
+static double seconds_since(build_clock::time_point start) {
+	return std::chrono::duration<double>(build_clock::now() - start).count();
+}
+
+// for sums over lengths with no words
+static const long none = -1;
+
+int main(int argc, char** argv) try {
+	if (argc < 4 || argc > 6) {
+		fprintf(stderr, "usage: %s <lexicon> <successors> <snapshot> "
+				"[layers] [threads]\n", argv[0]);
+		return 2;
+	}
+	unsigned layers = argc > 4 ? atoi(argv[4]) : BOUNDS_LAYERS;
+	unsigned threads = argc > 5 ? atoi(argv[5]) :
+		std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	build_clock::time_point start = build_clock::now();
+	lexicon lex(argv[1]);
+	successor_graph graph(lex, argv[2]);
+	size_t longest = 0;
+	for (word_id id = 0; id < lex.size(); id++) {
+		longest = std::max<size_t>(longest, lex.length(id));
+	}
+	double load_time = seconds_since(start);
+
+	// bounds[id * stride + r] is word id's bound with r moves
+	build_clock::time_point layer_start = build_clock::now();
+	size_t stride = layers + 1;
+	std::vector<uint16_t> bounds(lex.size() * stride, 0);
+	// best[r][n]: the highest budget r bound among words of length n
+	std::vector<std::vector<long> > best(stride,
+			std::vector<long>(longest + 2, none));
+	// one_or_more[b][n]: the most that split parts totalling n letters can
+	// score, points and bounds, sharing b moves among them
+	std::vector<std::vector<long> > one_or_more(stride,
+			std::vector<long>(longest + 2, none));
+	std::vector<long> two_or_more(longest + 2, none);
+
+	for (word_id id = 0; id < lex.size(); id++) {
+		size_t n = lex.length(id);
+		if (n < MIN_WORD_LENGTH) continue;
+		bounds[id * stride] = n - 3;
+		best[0][n] = std::max<long>(best[0][n], n - 3);
+	}
+
+	std::atomic<bool> overflow(false);
+	for (unsigned r = 1; r <= layers; r++) {
+		// a split spends one move; its parts share the other r - 1.  Every
+		// smaller budget's row is final, so one_or_more[b] only needs adding.
+		unsigned b = r - 1;
+		auto part = [&] (size_t n, unsigned moves) {
+			return best[moves][n] == none ? none :
+				static_cast<long>(n) - 3 + best[moves][n];
+		};
+		for (size_t n = 0; n <= longest + 1; n++) {
+			long most = none;
+			for (size_t first = MIN_WORD_LENGTH; first + MIN_WORD_LENGTH <= n;
+					first++) {
+				for (unsigned moves = 0; moves <= b; moves++) {
+					long head = part(first, moves);
+					long rest = one_or_more[b - moves][n - first];
+					if (head != none && rest != none) {
+						most = std::max(most, head + rest);
+					}
+				}
+			}
+			two_or_more[n] = most;
+			one_or_more[b][n] = std::max(part(n, b), most);
+		}
+
+		// workers claim chunks of word IDs and write only their own words'
+		// budget r bounds
+		std::atomic<word_id> next(0);
+		const word_id chunk = 1024;
+		auto work = [&] () {
+			for (word_id first = next.fetch_add(chunk); first < lex.size();
+					first = next.fetch_add(chunk)) {
+				word_id last = std::min<word_id>(first + chunk, lex.size());
+				for (word_id id = first; id < last; id++) {
+					size_t n = lex.length(id);
+					if (n < MIN_WORD_LENGTH) continue;
+					long bound = std::max(static_cast<long>(n) - 3,
+							two_or_more[n + 1]);
+					for (word_id next_word : graph.successors(id)) {
+						bound = std::max<long>(bound, lex.length(next_word) - 3 +
+								bounds[next_word * stride + b]);
+					}
+					if (bound > UINT16_MAX) overflow = true;
+					bounds[id * stride + r] = std::min<long>(bound, UINT16_MAX);
+				}
+			}
+		};
+		std::vector<std::thread> workers;
+		for (unsigned i = 1; i < threads; i++) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (auto& w : workers) {
+			w.join();
+		}
+		if (overflow) {
+			throw std::runtime_error("Bounds overflow; use fewer layers.");
+		}
+
+		for (word_id id = 0; id < lex.size(); id++) {
+			size_t n = lex.length(id);
+			if (n < MIN_WORD_LENGTH) continue;
+			best[r][n] = std::max<long>(best[r][n], bounds[id * stride + r]);
+		}
+	}
+	double layer_time = seconds_since(layer_start);
+
+	build_clock::time_point write_start = build_clock::now();
+	bound_table::write_snapshot(bounds, lex.size(), layers, argv[3]);
+	double write_time = seconds_since(write_start);
+
+	fprintf(stderr, "%s: %lu words, %u layers, %u threads; "
+			"load %.3f s, layers %.3f s, write %.3f s\n", argv[3],
+			static_cast<unsigned long>(lex.size()), layers, threads,
+			load_time, layer_time, write_time);
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
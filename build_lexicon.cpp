@@ -0,0 +1,196 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Expands a Hunspell .aff/.dic pair into every lowercase a-z word form and
+// writes the result as a lexicon snapshot.
+// usage: build_lexicon <aff> <dic> <snapshot>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "spell_pool.hpp"
+
+struct affix_rule {
+	std::string strip;
+	std::string add;
+	// one entry per condition position; each is a set of chars, negated if
+	// its first char is '^'
+	std::vector<std::string> condition;
+};
+
+struct affix_class {
+	bool is_prefix;
+	bool cross_product;
+	std::vector<affix_rule> rules;
+};
+
+static std::vector<std::string> parse_condition(std::string const& cond) {
+	std::vector<std::string> parts;
+	for (size_t i = 0; i < cond.size(); i++) {
+		if (cond[i] == '.') {
+			parts.push_back("");
+		} else if (cond[i] == '[') {
+			size_t close = cond.find(']', i);
+			if (close == std::string::npos) {
+				throw std::runtime_error("Bad affix condition " + cond);
+			}
+			parts.push_back(cond.substr(i + 1, close - i - 1));
+			i = close;
+		} else {
+			parts.push_back(std::string(1, cond[i]));
+		}
+	}
+	return parts;
+}
+
+static bool char_matches(char c, std::string const& part) {
+	// "" is '.', matching anything
+	if (part.empty()) return true;
+	if (part[0] == '^') return part.find(c, 1) == std::string::npos;
+	return part.find(c) != std::string::npos;
+}
+
+static bool condition_matches(affix_rule const& rule, std::string const& w,
+		bool is_prefix) {
+	size_t n = rule.condition.size();
+	if (n == 1 && rule.condition[0].empty()) return true;
+	if (w.size() < n) return false;
+	size_t start = is_prefix ? 0 : w.size() - n;
+	for (size_t i = 0; i < n; i++) {
+		if (!char_matches(w[start + i], rule.condition[i])) return false;
+	}
+	return true;
+}
+
+static bool apply(affix_rule const& rule, std::string const& w, bool is_prefix,
+		std::string& out) {
+	if (!condition_matches(rule, w, is_prefix) || rule.strip.size() >= w.size()) {
+		return false;
+	}
+	if (is_prefix) {
+		if (w.compare(0, rule.strip.size(), rule.strip) != 0) return false;
+		out = rule.add + w.substr(rule.strip.size());
+	} else {
+		if (w.compare(w.size() - rule.strip.size(), rule.strip.size(),
+					rule.strip) != 0) {
+			return false;
+		}
+		out = w.substr(0, w.size() - rule.strip.size()) + rule.add;
+	}
+	return true;
+}
+
+static std::map<char, affix_class> read_aff(char const* path) {
+	std::ifstream in(path);
+	if (!in) {
+		throw std::runtime_error(std::string("Couldn't read ") + path + ".");
+	}
+	std::map<char, affix_class> classes;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::istringstream ss(line);
+		std::string kind, flag, a, b, c;
+		ss >> kind >> flag >> a >> b;
+		if ((kind != "PFX" && kind != "SFX") || flag.size() != 1) continue;
+		affix_class& cls = classes[flag[0]];
+		if (!(ss >> c)) {
+			// class header: cross product flag and rule count
+			cls.is_prefix = kind == "PFX";
+			cls.cross_product = a == "Y";
+			continue;
+		}
+		affix_rule rule;
+		rule.strip = a == "0" ? "" : a;
+		rule.add = b == "0" ? "" : b.substr(0, b.find('/'));
+		rule.condition = parse_condition(c);
+		cls.rules.push_back(rule);
+	}
+	return classes;
+}
+
+static bool is_game_word(std::string const& w) {
+	return !w.empty() && std::all_of(w.begin(), w.end(),
+			[] (char c) { return c >= 'a' && c <= 'z'; });
+}
+
+int main(int argc, char** argv) try {
+	if (argc != 4) {
+		fprintf(stderr, "usage: %s <aff> <dic> <snapshot>\n", argv[0]);
+		return 2;
+	}
+	std::map<char, affix_class> classes = read_aff(argv[1]);
+
+	std::ifstream dic(argv[2]);
+	if (!dic) {
+		throw std::runtime_error(std::string("Couldn't read ") + argv[2] + ".");
+	}
+	std::vector<std::string> forms;
+	std::string line;
+	std::getline(dic, line); // approximate entry count
+	while (std::getline(dic, line)) {
+		size_t slash = line.find('/');
+		std::string stem = line.substr(0, slash);
+		std::string flags = slash == std::string::npos ? "" :
+			line.substr(slash + 1);
+		forms.push_back(stem);
+
+		std::string sfx_form, pfx_form;
+		for (char f : flags) {
+			auto it = classes.find(f);
+			if (it == classes.end()) continue;
+			affix_class const& cls = it->second;
+			for (auto const& rule : cls.rules) {
+				if (!apply(rule, stem, cls.is_prefix, sfx_form)) continue;
+				forms.push_back(sfx_form);
+				if (cls.is_prefix || !cls.cross_product) continue;
+				// suffixed forms may also take any cross product prefix
+				for (char g : flags) {
+					auto jt = classes.find(g);
+					if (jt == classes.end() || !jt->second.is_prefix ||
+							!jt->second.cross_product) {
+						continue;
+					}
+					for (auto const& prule : jt->second.rules) {
+						if (apply(prule, sfx_form, true, pfx_form)) {
+							forms.push_back(pfx_form);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<std::string> words;
+	for (auto const& w : forms) {
+		if (is_game_word(w)) words.push_back(w);
+	}
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	// the expansion above is only a generator; Hunspell stays the authority on
+	// what is a word, so that the snapshot answers exactly as spell() would
+	spell_pool spell(argv[1], argv[2]);
+	std::vector<char> right = spell.check(words);
+	size_t kept = 0;
+	for (size_t i = 0; i < words.size(); i++) {
+		if (right[i]) words[kept++].swap(words[i]);
+	}
+	words.resize(kept);
+
+	lexicon::write_snapshot(words, argv[3]);
+	fprintf(stderr, "%s: %lu words\n", argv[3],
+			static_cast<unsigned long>(words.size()));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Stems every word of a lexicon snapshot with WordNet and Hunspell and writes
+// the result as a stem table snapshot.  Run from the directory holding the
+// Hunspell dictionary; WordNet is found the usual way (WNSEARCHDIR).  Words
+// are stemmed on threads threads, one per core by default.
+// usage: build_stems <lexicon> <snapshot> [threads]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "stem_interner.hpp"
+#include "stem_table.hpp"
+#include "stemmer.hpp"
+
+// words a stemming thread takes at a time
+#define BUILD_STEMS_BATCH 256
+
+int main(int argc, char** argv) try {
+	if (argc < 3 || argc > 4) {
+		fprintf(stderr, "usage: %s <lexicon> <snapshot> [threads]\n", argv[0]);
+		return 2;
+	}
+	lexicon lex(argv[1]);
+	unsigned threads = argc > 3 ? atoi(argv[3]) :
+		std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+	stemmer stem(lex);
+
+	std::vector<std::set<std::string> > stems(lex.size());
+	std::atomic<size_t> next(0);
+	auto work = [&] () {
+		for (;;) {
+			size_t begin = next.fetch_add(BUILD_STEMS_BATCH);
+			if (begin >= lex.size()) return;
+			size_t end = std::min<size_t>(begin + BUILD_STEMS_BATCH, lex.size());
+			for (word_id id = begin; id < end; id++) {
+				if (lex.length(id) < MIN_WORD_LENGTH) continue;
+				stems[id] = stem.stems(lex.literal(id));
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < threads; i++) {
+		pool.emplace_back(work);
+	}
+	work();
+	for (auto& t : pool) {
+		t.join();
+	}
+
+	// interned in word order, so stem IDs don't depend on the threads
+	stem_interner interned;
+	std::vector<uint32_t> word_offsets;
+	std::vector<stem_id> links;
+	word_offsets.reserve(lex.size() + 1);
+	for (word_id id = 0; id < lex.size(); id++) {
+		word_offsets.push_back(links.size());
+		for (auto const& s : stems[id]) {
+			links.push_back(interned.intern(s));
+		}
+	}
+	word_offsets.push_back(links.size());
+
+	std::vector<std::string> names;
+	for (stem_id id = 0; id < interned.size(); id++) {
+		names.push_back(interned.name(id));
+	}
+	stem_table::write_snapshot(word_offsets, links, names, argv[2]);
+	fprintf(stderr, "%s: %lu words, %lu stems, %lu links\n", argv[2],
+			static_cast<unsigned long>(lex.size()),
+			static_cast<unsigned long>(names.size()),
+			static_cast<unsigned long>(links.size()));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
@@ -0,0 +1,95 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Computes every word's add-one-letter successors from a lexicon snapshot and
+// writes them as a successor graph snapshot.
+// usage: build_successors <lexicon> <snapshot> [threads]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "lexicon.hpp"
+#include "successor_graph.hpp"
+
+typedef std::chrono::steady_clock build_clock;
+
+static double seconds_since(build_clock::time_point start) {
+	return std::chrono::duration<double>(build_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) try {
+	if (argc != 3 && argc != 4) {
+		fprintf(stderr, "usage: %s <lexicon> <snapshot> [threads]\n", argv[0]);
+		return 2;
+	}
+	unsigned threads = argc == 4 ? atoi(argv[3]) :
+		std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	build_clock::time_point start = build_clock::now();
+	lexicon lex(argv[1]);
+	anagram_index index(lex);
+	double index_time = seconds_since(start);
+
+	// workers claim chunks of word IDs; each word's row is private to its
+	// claimant, so rows need no locking
+	build_clock::time_point expand_start = build_clock::now();
+	std::vector<std::vector<word_id> > rows(lex.size());
+	std::atomic<word_id> next(0);
+	const word_id chunk = 1024;
+	auto work = [&] () {
+		std::string signature;
+		for (word_id first = next.fetch_add(chunk); first < lex.size();
+				first = next.fetch_add(chunk)) {
+			word_id last = std::min<word_id>(first + chunk, lex.size());
+			for (word_id id = first; id < last; id++) {
+				if (lex.length(id) < MIN_WORD_LENGTH) continue;
+				signature.assign(lex.literal(id), lex.length(id));
+				std::sort(signature.begin(), signature.end());
+				// kept in the index's order, by letter added, which is the
+				// order moves have always been generated and searched in
+				index.successors(signature, rows[id]);
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threads; i++) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (auto& w : workers) {
+		w.join();
+	}
+	double expand_time = seconds_since(expand_start);
+
+	build_clock::time_point write_start = build_clock::now();
+	std::vector<uint32_t> offsets;
+	std::vector<word_id> targets;
+	offsets.reserve(rows.size() + 1);
+	for (auto const& row : rows) {
+		offsets.push_back(targets.size());
+		targets.insert(targets.end(), row.begin(), row.end());
+	}
+	offsets.push_back(targets.size());
+	successor_graph::write_snapshot(offsets, targets, argv[2]);
+	double write_time = seconds_since(write_start);
+
+	fprintf(stderr, "%s: %lu words, %lu edges, %u threads; "
+			"index %.3f s, expand %.3f s, write %.3f s\n", argv[2],
+			static_cast<unsigned long>(lex.size()),
+			static_cast<unsigned long>(targets.size()), threads,
+			index_time, expand_time, write_time);
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
@@ -0,0 +1,265 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "engine.hpp"
+
+word::word(std::string const& w) : literal(w), sorted(w),
+		histogram(w.data(), w.size()) {
+	std::sort(sorted.begin(), sorted.end());
+}
+
+bool word::operator< (word const& other) const {
+	return literal < other.literal;
+}
+
+bool word::is_one_less_than(letter_histogram const& other) const {
+	return is_one_letter_more(other, histogram);
+}
+
+char const* move_message(move_status status) {
+	switch (status) {
+		case move_status::ok: return "%s";
+		case move_status::too_long: return "Input length exceeded.";
+		case move_status::not_current: return "'%s' is not a current word.";
+		case move_status::no_words: return "Need at least one word...";
+		case move_status::malformed: return "'%s' is not alpha/too short";
+		case move_status::not_anagram: return "Not a valid anagram + extra letter";
+		case move_status::not_a_word: return "'%s' isn't a valid word";
+		case move_status::stem_used: return "'%s' already used previously";
+	}
+	return "%s";
+}
+
+std::vector<std::string> read_start_words(char const* path) {
+	std::ifstream in(path);
+	if (!in) {
+		throw std::runtime_error("Couldn't read valid words.");
+	}
+	std::vector<std::string> choices;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (line.size() == START_WORD_LENGTH) choices.push_back(line);
+	}
+	if (choices.empty()) {
+		throw std::runtime_error("Couldn't read valid words.");
+	}
+	return choices;
+}
+
+static move_result failure(move_status status,
+		boost::string_ref subject = boost::string_ref()) {
+	move_result result;
+	result.status = status;
+	result.points = 0;
+	size_t n = std::min(subject.size(), sizeof(result.subject) - 1);
+	memcpy(result.subject, subject.data(), n);
+	result.subject[n] = '\0';
+	return result;
+}
+
+game_state engine::new_game() const {
+	return game_state();
+}
+
+// used_stems as the searches take it
+static stem_set flatten(persistent_bitset const& used, size_t stem_count) {
+	stem_set flat(stem_count);
+	used.for_each([&] (stem_id id) { flat.insert(id); });
+	return flat;
+}
+
+bool engine::start(game_state& state, std::string const& str) {
+	std::string literal = str;
+	if (!lowercase_and_validate(literal) ||
+			literal.size() != START_WORD_LENGTH || !lex.contains(literal)) {
+		return false;
+	}
+	state.current.insert(lex.find(literal));
+	stem_range s = stems.stems(literal);
+	state.used_stems.insert(s.begin(), s.end());
+	return true;
+}
+
+move_result engine::apply_move(game_state& state, char const* input,
+		game_move* made) {
+	move_result result = check_move(state, input, checked);
+	if (result.status == move_status::ok) {
+		play(state, checked);
+		if (made != nullptr) *made = checked;
+	}
+	return result;
+}
+
+move_result engine::check_move(game_state const& state, char const* input,
+		game_move& m) const {
+	parsed_move parsed;
+	if (!parse_move(input, parsed)) {
+		return failure(move_status::too_long);
+	}
+
+	// is the first word in our current set?
+	boost::string_ref chosen = parsed.chosen.text;
+	auto chosen_it = state.current.find(lex.find(chosen.data(), chosen.size()));
+	if (chosen_it == state.current.end()) {
+		return failure(move_status::not_current, chosen);
+	}
+
+	// make sure the candidates are are lowercase alpha and at least 3 chars
+	// long
+	if (parsed.word_count == 0) {
+		return failure(move_status::no_words);
+	}
+	if (parsed.malformed) {
+		return failure(move_status::malformed,
+				parsed.words[parsed.word_count - 1].text);
+	}
+	if (!is_one_letter_more(parsed.words_histogram, parsed.chosen.histogram)) {
+		return failure(move_status::not_anagram);
+	}
+
+	// the game only holds lexicon words, even where the live stemmer knows
+	// more, so a word the lexicon lacks isn't a word
+	m.chosen = *chosen_it;
+	m.words.clear();
+	for (size_t i = 0; i < parsed.word_count; i++) {
+		boost::string_ref w = parsed.words[i].text;
+		m.words.push_back(lex.find(w.data(), w.size()));
+	}
+	return check(state, m, parsed.words);
+}
+
+move_result engine::apply_move(game_state& state, game_move& m) {
+	auto chosen_it = state.current.find(m.chosen);
+	if (chosen_it == state.current.end()) {
+		return failure(move_status::not_current,
+				m.chosen < lex.size() ? lex.literal(m.chosen) : "");
+	}
+	if (m.words.empty()) {
+		return failure(move_status::no_words);
+	}
+	letter_histogram words_histogram;
+	for (word_id id : m.words) {
+		if (id >= lex.size() || lex.length(id) < MIN_WORD_LENGTH) {
+			return failure(move_status::malformed);
+		}
+		words_histogram.add(lex.literal(id), lex.length(id));
+	}
+	letter_histogram chosen_histogram(lex.literal(m.chosen),
+			lex.length(m.chosen));
+	if (!is_one_letter_more(words_histogram, chosen_histogram)) {
+		return failure(move_status::not_anagram);
+	}
+	move_result result = check(state, m, nullptr);
+	if (result.status == move_status::ok) play(state, m);
+	return result;
+}
+
+// the checks on the new words' stems, filling in m's points and stems.  names,
+// if given, are the words as typed, for messages about words the lexicon
+// lacks.
+move_result engine::check(game_state const& state, game_move& m,
+		move_token const* names) const {
+	auto name = [&] (size_t i) {
+		return names != nullptr ? names[i].text :
+			boost::string_ref(lex.literal(m.words[i]), lex.length(m.words[i]));
+	};
+	m.points = 0;
+	// a handful of stems at most, so a linear scan beats a set
+	m.stems.clear();
+	for (size_t i = 0; i < m.words.size(); i++) {
+		word_id id = m.words[i];
+		// is this even a real word?
+		stem_range s = stems.stems(id);
+		if (s.empty()) {
+			return failure(move_status::not_a_word, name(i));
+		}
+		// is at least one stem of this word used?
+		for (auto const& stem : s) {
+			if (state.used_stems.contains(stem) ||
+					std::find(m.stems.begin(), m.stems.end(), stem) !=
+						m.stems.end()) {
+				return failure(move_status::stem_used, name(i));
+			}
+			m.stems.push_back(stem);
+		}
+		m.points += lex.length(id) - 3;
+	}
+
+	move_result result = failure(move_status::ok);
+	result.points = m.points;
+	return result;
+}
+
+// a move that has passed check()
+void engine::play(game_state& state, game_move const& m) const {
+	state.score += m.points;
+	state.used_stems.insert(m.stems.begin(), m.stems.end());
+	state.prior.insert(m.chosen);
+	state.current.erase(m.chosen);
+	state.current.insert(m.words.begin(), m.words.end());
+}
+
+void engine::restore_stems(game_state& state) {
+	auto use = [&] (word_id id) {
+		stem_range s = stems.stems(id);
+		state.used_stems.insert(s.begin(), s.end());
+	};
+	state.prior.for_each(use);
+	state.current.for_each(use);
+}
+
+unsigned long engine::final_score(game_state const& state) const {
+	unsigned long total = state.score;
+	for (word_id id : state.current) {
+		total += lex.length(id) - 3;
+	}
+	return total;
+}
+
+void engine::build_index() {
+	if (!generator) {
+		index.reset(new anagram_index(lex));
+		graph.reset(new successor_graph(lex, SUCCESSORS_SNAPSHOT));
+		generator.reset(new move_generator(lex, *index, *graph, stems));
+	}
+}
+
+void engine::hints(game_state const& state, std::vector<game_move>& out) {
+	build_index();
+	out.clear();
+	stem_set used = flatten(state.used_stems, stems.stem_count());
+	for (word_id id : state.current) {
+		generator->moves_from(id, used, out);
+	}
+	std::stable_sort(out.begin(), out.end(),
+			[] (game_move const& a, game_move const& b) {
+				return a.points > b.points;
+			});
+}
+
+mcts_advice engine::advise(game_state const& state,
+		mcts_options const& options) {
+	build_index();
+	return mcts(lex, *index, *graph, stems).search(to_position(state), options);
+}
+
+position engine::to_position(game_state const& state) const {
+	position p;
+	p.current = state.current.words();
+	for (word_id id : state.current) {
+		p.bonus += lex.length(id) - 3;
+		p.hash ^= zobrist_word(id);
+	}
+	p.used = flatten(state.used_stems, stems.stem_count());
+	state.used_stems.for_each([&] (stem_id id) {
+		p.hash ^= zobrist_stem(id);
+	});
+	p.score = state.score;
+	return p;
+}
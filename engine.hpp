@@ -0,0 +1,122 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "letter_histogram.hpp"
+#include "lexicon.hpp"
+#include "mcts.hpp"
+#include "move_generator.hpp"
+#include "move_parser.hpp"
+#include "persistent_bitset.hpp"
+#include "stem_set.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+#include "word_set.hpp"
+
+#define START_WORDS "valid_words.txt"
+#define START_WORD_LENGTH 3
+
+struct word {
+	std::string literal;
+	std::string sorted;
+	letter_histogram histogram;
+
+	word(std::string const& w);
+	bool operator< (word const& other) const;
+	bool is_one_less_than(letter_histogram const& other) const;
+};
+
+// prior and used_stems only ever grow, and share structure between copies, so
+// a copy costs about as much as its current words
+struct game_state {
+	// IDs into the engine's lexicon
+	word_set current;
+	persistent_bitset prior;
+	persistent_bitset used_stems;
+	unsigned long score;
+
+	game_state() : score(0) {}
+};
+
+enum class move_status {
+	ok,
+	too_long,
+	not_current,
+	no_words,
+	malformed,
+	not_anagram,
+	not_a_word,
+	stem_used
+};
+
+struct move_result {
+	move_status status;
+	// the word the status is about, if any
+	char subject[MAX_INPUT_LENGTH];
+	// points scored by an accepted move
+	unsigned long points;
+};
+
+// printf format for a status, taking the result's subject as its one argument
+char const* move_message(move_status status);
+
+// the 3-letter start words offered by a random start
+std::vector<std::string> read_start_words(char const* path = START_WORDS);
+
+// the rules of the game, with no user interface attached
+class engine {
+	lexicon const& lex;
+	stem_source& stems;
+	// built on the first hints() or advise() call, since most games never ask
+	std::unique_ptr<anagram_index> index;
+	std::unique_ptr<successor_graph> graph;
+	std::unique_ptr<move_generator> generator;
+	// the last text move checked, kept so its vectors are reused
+	game_move checked;
+
+	void build_index();
+	move_result check(game_state const& state, game_move& m,
+			move_token const* names) const;
+	void play(game_state& state, game_move const& m) const;
+
+	public:
+	engine(lexicon const& lex, stem_source& stems) : lex(lex), stems(stems) {}
+
+	lexicon const& words() const { return lex; }
+	stem_source& stem_lookup() { return stems; }
+
+	// an empty game
+	game_state new_game() const;
+	// false unless str is a 3-letter word
+	bool start(game_state& state, std::string const& str);
+	// input is "<current word> <new words separated by spaces>"; state is only
+	// changed if the move is accepted.  If made isn't null, an accepted move
+	// is stored there by ID.
+	move_result apply_move(game_state& state, char const* input,
+			game_move* made = nullptr);
+	// whether apply_move would accept input, leaving state alone.  Allocates
+	// nothing once m has held a move as long.
+	move_result check_move(game_state const& state, char const* input,
+			game_move& m) const;
+	// the same by ID, for replaying moves without parsing them; fills in m's
+	// points and stems
+	move_result apply_move(game_state& state, game_move& m);
+	// sets used_stems from scratch to the stems of every word in the game: a
+	// state's stems all came in with its words, the start word's included
+	void restore_stems(game_state& state);
+	// the score with current words counted double
+	unsigned long final_score(game_state const& state) const;
+	// every legal move from the current words, highest scoring first
+	void hints(game_state const& state, std::vector<game_move>& out);
+	// the move a Monte Carlo tree search favours, within options' budget
+	mcts_advice advise(game_state const& state,
+			mcts_options const& options = mcts_options());
+	// state by word ID, for the searches
+	position to_position(game_state const& state) const;
+};
@@ -0,0 +1,128 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "engine.hpp"
+
+// moves between full copies of the current words
+#define HISTORY_SNAPSHOT_MOVES 64
+
+// every state a game has been in, for unlimited undo and redo.  A move keeps
+// only what it changed: the current words it took away and added, and the
+// prior words and used stems after it, which share all but the move's own
+// nodes with the states before.  Every HISTORY_SNAPSHOT_MOVES moves the
+// current words are copied whole, so going back or forward any number of
+// moves replays at most that many moves' changes from the nearest copy.
+class game_history {
+	struct step {
+		// into changed: the current words the move took away, then those it
+		// added; never both
+		size_t first;
+		size_t removed;
+		size_t added;
+		persistent_bitset prior;
+		persistent_bitset used_stems;
+		unsigned long score;
+
+		size_t end() const { return first + removed + added; }
+	};
+	// steps[i] leads to state i; steps[0] is the start and changes nothing
+	std::vector<step> steps;
+	// every step's words, back to back
+	std::vector<word_id> changed;
+	// current words of states 0, HISTORY_SNAPSHOT_MOVES, 2 *
+	// HISTORY_SNAPSHOT_MOVES and so on
+	std::vector<word_set> snapshots;
+	// index of the state the game is in, and that state
+	size_t at;
+	game_state now;
+
+	// the step from from to to, its words appended to changed
+	step changes(game_state const& from, game_state const& to) {
+		std::vector<word_id> const& a = from.current.words();
+		std::vector<word_id> const& b = to.current.words();
+		step s;
+		s.first = changed.size();
+		std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+				std::back_inserter(changed));
+		s.removed = changed.size() - s.first;
+		std::set_difference(b.begin(), b.end(), a.begin(), a.end(),
+				std::back_inserter(changed));
+		s.added = changed.size() - s.first - s.removed;
+		s.prior = to.prior;
+		s.used_stems = to.used_stems;
+		s.score = to.score;
+		return s;
+	}
+
+	// moves now to state i, from here or from the nearest snapshot below i,
+	// whichever has fewer steps between
+	void go_to(size_t i) {
+		size_t base = i - i % HISTORY_SNAPSHOT_MOVES;
+		size_t from_here = i > at ? i - at : at - i;
+		if (i - base < from_here) {
+			now.current = snapshots[base / HISTORY_SNAPSHOT_MOVES];
+			at = base;
+		}
+		for (; at > i; at--) {
+			step const& s = steps[at];
+			word_id const* removed = changed.data() + s.first;
+			word_id const* added = removed + s.removed;
+			for (size_t j = 0; j < s.added; j++) {
+				now.current.erase(added[j]);
+			}
+			now.current.insert(removed, removed + s.removed);
+		}
+		for (; at < i; at++) {
+			step const& s = steps[at + 1];
+			word_id const* removed = changed.data() + s.first;
+			word_id const* added = removed + s.removed;
+			for (size_t j = 0; j < s.removed; j++) {
+				now.current.erase(removed[j]);
+			}
+			now.current.insert(added, added + s.added);
+		}
+		now.prior = steps[at].prior;
+		now.used_stems = steps[at].used_stems;
+		now.score = steps[at].score;
+	}
+
+	public:
+	explicit game_history(game_state const& start)
+		: snapshots(1, start.current), at(0), now(start) {
+		steps.push_back(changes(start, start));
+	}
+
+	game_state const& state() const { return now; }
+	// moves made to reach state(), and moves undone since
+	size_t moves() const { return at; }
+	size_t undone() const { return steps.size() - at - 1; }
+
+	// records the state after a move, forgetting any moves undone before it
+	void push(game_state const& next) {
+		steps.resize(at + 1);
+		changed.resize(steps[at].end());
+		snapshots.resize(at / HISTORY_SNAPSHOT_MOVES + 1);
+		steps.push_back(changes(now, next));
+		now = next;
+		at++;
+		if (at % HISTORY_SNAPSHOT_MOVES == 0) snapshots.push_back(now.current);
+	}
+
+	// steps back or forward n moves, or as many as there are; how many it went
+	size_t undo(size_t n = 1) {
+		n = std::min(n, at);
+		go_to(at - n);
+		return n;
+	}
+	size_t redo(size_t n = 1) {
+		n = std::min(n, undone());
+		go_to(at + n);
+		return n;
+	}
+};
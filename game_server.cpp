@@ -0,0 +1,254 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "game_server.hpp"
+
+// events taken from epoll per wait
+#define SERVER_EVENTS 256
+
+static std::runtime_error system_error(std::string const& what) {
+	return std::runtime_error(what + ": " + strerror(errno));
+}
+
+game_server::game_server(engine& rules, char const* path)
+	: rules(rules), start_words(read_start_words()),
+	random(std::random_device()()), path(path), listener(-1), poller(-1) {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Socket path is too long.");
+	}
+	strcpy(address.sun_path, path);
+
+	listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listener < 0) throw system_error("Couldn't make a socket");
+	unlink(path);
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address),
+				sizeof(address)) != 0) {
+		close(listener);
+		throw system_error(std::string("Couldn't bind ") + path);
+	}
+	if (listen(listener, SOMAXCONN) != 0) {
+		close(listener);
+		throw system_error("Couldn't listen");
+	}
+
+	poller = epoll_create1(EPOLL_CLOEXEC);
+	if (poller < 0) {
+		close(listener);
+		throw system_error("Couldn't make an epoll instance");
+	}
+	epoll_event e;
+	memset(&e, 0, sizeof(e));
+	e.events = EPOLLIN;
+	e.data.fd = listener;
+	epoll_ctl(poller, EPOLL_CTL_ADD, listener, &e);
+}
+
+game_server::~game_server() {
+	for (auto& entry : sessions) {
+		close(entry.first);
+	}
+	close(poller);
+	close(listener);
+	unlink(path.c_str());
+}
+
+void game_server::accept_all() {
+	for (;;) {
+		int fd = accept4(listener, nullptr, nullptr,
+				SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			// out of descriptors or the like: leave the rest queued
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				perror("accept");
+			}
+			return;
+		}
+		epoll_event e;
+		memset(&e, 0, sizeof(e));
+		e.events = EPOLLIN;
+		e.data.fd = fd;
+		if (epoll_ctl(poller, EPOLL_CTL_ADD, fd, &e) != 0) {
+			close(fd);
+			continue;
+		}
+		sessions[fd].reset(new session(fd, rules.new_game()));
+	}
+}
+
+std::string game_server::handle(session& s, std::string const& line,
+		bool& quit) {
+	std::istringstream in(line);
+	std::string command;
+	in >> command;
+	char reply[MAX_INPUT_LENGTH + 64];
+
+	if (command == "start") {
+		std::string word;
+		in >> word;
+		if (word == "random") {
+			word = start_words[random() % start_words.size()];
+		}
+		game_state state = rules.new_game();
+		if (!rules.start(state, word)) return "err Not a start word.";
+		s.state = state;
+		s.history = game_history(state);
+		// the word as the engine took it, lowercased
+		word_id started = *state.current.begin();
+		lexicon const& lex = rules.words();
+		return "ok " + std::string(lex.literal(started), lex.length(started));
+	} else if (command == "move") {
+		std::string input;
+		std::getline(in >> std::ws, input);
+		move_result result = rules.apply_move(s.state, input.c_str());
+		if (result.status != move_status::ok) {
+			snprintf(reply, sizeof(reply), move_message(result.status),
+					result.subject);
+			return std::string("err ") + reply;
+		}
+		s.history.push(s.state);
+		snprintf(reply, sizeof(reply), "ok %lu %lu", result.points,
+				s.state.score);
+		return reply;
+	} else if (command == "undo" || command == "redo") {
+		unsigned long n;
+		if (!(in >> n)) n = 1;
+		size_t went = command == "undo" ? s.history.undo(n) : s.history.redo(n);
+		s.state = s.history.state();
+		snprintf(reply, sizeof(reply), "ok %lu %lu",
+				static_cast<unsigned long>(went), s.state.score);
+		return reply;
+	} else if (command == "score") {
+		snprintf(reply, sizeof(reply), "ok %lu %lu", s.state.score,
+				rules.final_score(s.state));
+		return reply;
+	} else if (command == "words") {
+		std::string words = "ok";
+		lexicon const& lex = rules.words();
+		for (word_id id : s.state.current) {
+			words += ' ';
+			words.append(lex.literal(id), lex.length(id));
+		}
+		return words;
+	} else if (command == "quit") {
+		quit = true;
+		return "ok";
+	}
+	return "err Unknown command.";
+}
+
+bool game_server::read_from(session& s) {
+	char buffer[16384];
+	bool eof = false;
+	for (;;) {
+		ssize_t n = read(s.fd, buffer, sizeof(buffer));
+		if (n == 0) {
+			eof = true;
+			break;
+		}
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		s.in.append(buffer, n);
+		if (static_cast<size_t>(n) < sizeof(buffer)) break;
+	}
+
+	bool& quit = s.closing;
+	size_t line = 0;
+	for (size_t eol; !quit &&
+			(eol = s.in.find('\n', line)) != std::string::npos;
+			line = eol + 1) {
+		std::string request = s.in.substr(line, eol - line);
+		if (!request.empty() && request.back() == '\r') request.pop_back();
+		s.out += handle(s, request, quit);
+		s.out += '\n';
+	}
+	s.in.erase(0, line);
+	if (s.in.size() > SERVER_MAX_LINE) {
+		s.out += "err Request too long.\n";
+		quit = true;
+	}
+	// a client that has stopped sending still gets the replies to the
+	// requests it sent; a partial last line is never answered
+	if (eof) quit = true;
+	// what's already answered still goes out, as far as it will without
+	// blocking; a session that has quit stays open until all of it has
+	return write_to(s);
+}
+
+bool game_server::write_to(session& s) {
+	size_t sent = 0;
+	while (sent < s.out.size()) {
+		ssize_t n = send(s.fd, s.out.data() + sent, s.out.size() - sent,
+				MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		sent += n;
+	}
+	s.out.erase(0, sent);
+	if (s.closing && s.out.empty()) return false;
+	// while replies are backed up, wait for room to send them rather than
+	// reading more requests, so a client that doesn't read can't grow out
+	// without bound.  A closing session reads nothing more either way.
+	if (s.out.empty() == s.blocked) {
+		s.blocked = !s.out.empty();
+		epoll_event e;
+		memset(&e, 0, sizeof(e));
+		e.events = s.blocked ? EPOLLOUT : EPOLLIN;
+		e.data.fd = s.fd;
+		epoll_ctl(poller, EPOLL_CTL_MOD, s.fd, &e);
+	}
+	return true;
+}
+
+void game_server::close_session(session& s) {
+	int fd = s.fd;
+	epoll_ctl(poller, EPOLL_CTL_DEL, fd, nullptr);
+	close(fd);
+	sessions.erase(fd);
+}
+
+void game_server::run(volatile sig_atomic_t const& stop) {
+	epoll_event events[SERVER_EVENTS];
+	while (!stop) {
+		int n = epoll_wait(poller, events, SERVER_EVENTS, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			throw system_error("epoll_wait failed");
+		}
+		for (int i = 0; i < n; i++) {
+			int fd = events[i].data.fd;
+			if (fd == listener) {
+				accept_all();
+				continue;
+			}
+			auto it = sessions.find(fd);
+			if (it == sessions.end()) continue;
+			session& s = *it->second;
+			bool open = (events[i].events & (EPOLLERR | EPOLLHUP)) == 0;
+			if (open && (events[i].events & EPOLLOUT)) open = write_to(s);
+			if (open && (events[i].events & EPOLLIN)) open = read_from(s);
+			if (!open) close_session(s);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <csignal>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine.hpp"
+#include "game_history.hpp"
+
+#define SERVER_SOCKET "rat_trap_parts.sock"
+// longest request line; a client sending more is cut off
+#define SERVER_MAX_LINE 4096
+
+// The protocol is one request per line, each answered by one line starting
+// "ok" or "err <message>":
+//   start <word|random>      ok <start word>            a new game
+//   move <current> <new...>  ok <points> <score>
+//   undo [n], redo [n]       ok <moves gone> <score>
+//   score                    ok <score> <final score>
+//   words                    ok <current words>
+//   quit                     ok, then the server hangs up
+// Every connection is its own session with its own game.
+
+struct session {
+	int fd;
+	std::string in;
+	std::string out;
+	// true while waiting to send out, not reading
+	bool blocked;
+	// true once the session has quit; it ends when out has all been sent
+	bool closing;
+	game_state state;
+	game_history history;
+
+	session(int fd, game_state const& empty)
+		: fd(fd), blocked(false), closing(false), state(empty), history(empty) {}
+};
+
+// hosts any number of sessions on one thread with epoll.  The lexicon and
+// stems are shared by every session, so a session costs only its game.
+class game_server {
+	engine& rules;
+	std::vector<std::string> start_words;
+	std::mt19937 random;
+	std::string path;
+	int listener;
+	int poller;
+	std::unordered_map<int, std::unique_ptr<session> > sessions;
+
+	void accept_all();
+	// false once the session should be closed
+	bool read_from(session& s);
+	bool write_to(session& s);
+	void close_session(session& s);
+
+	public:
+	// listens on the Unix socket at path, replacing any stale one
+	game_server(engine& rules, char const* path = SERVER_SOCKET);
+	~game_server();
+	game_server(game_server const&) = delete;
+	game_server& operator= (game_server const&) = delete;
+
+	// the reply to one request line, without its newline; sets quit if the
+	// session should end
+	std::string handle(session& s, std::string const& line, bool& quit);
+
+	// serves until stop is set, as from a signal handler
+	void run(volatile sig_atomic_t const& stop);
+	size_t session_count() const { return sessions.size(); }
+};
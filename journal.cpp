@@ -0,0 +1,289 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "journal.hpp"
+
+static void put_varint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out += static_cast<char>(value | 0x80);
+		value >>= 7;
+	}
+	out += static_cast<char>(value);
+}
+
+// false if the varint runs past end
+static bool get_varint(char const*& p, char const* end, uint64_t& value) {
+	value = 0;
+	for (unsigned shift = 0; p != end && shift < 64; shift += 7) {
+		uint8_t byte = *p++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+// steps p over a count and that many varints; false if they run past end
+static bool skip_ids(char const*& p, char const* end) {
+	uint64_t count, value;
+	if (!get_varint(p, end, count)) return false;
+	for (uint64_t i = 0; i < count; i++) {
+		if (!get_varint(p, end, value)) return false;
+	}
+	return true;
+}
+
+// steps p over a whole record, setting kind; false if the record runs past
+// end
+static bool skip_record(char const*& p, char const* end, uint64_t& kind) {
+	uint64_t value;
+	if (!get_varint(p, end, kind)) return false;
+	if (kind == static_cast<uint64_t>(journal_record::begin)) {
+		return get_varint(p, end, value) && skip_ids(p, end) &&
+			skip_ids(p, end);
+	} else if (kind == static_cast<uint64_t>(journal_record::move)) {
+		return get_varint(p, end, value) && skip_ids(p, end);
+	} else if (kind == static_cast<uint64_t>(journal_record::undo) ||
+			kind == static_cast<uint64_t>(journal_record::redo)) {
+		return get_varint(p, end, value);
+	}
+	throw std::runtime_error("Journal is corrupt.");
+}
+
+// a set of IDs as a count and the gaps between them
+template<typename words> static void put_ids(std::string& out,
+		words const& ids) {
+	put_varint(out, ids.size());
+	uint64_t last = 0;
+	ids.for_each([&] (word_id id) {
+		put_varint(out, id - last);
+		last = id;
+	});
+}
+
+journal_writer::journal_writer(lexicon const& lex, game_state const& state,
+		char const* path) : fd(-1) {
+	journal_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+	h.version = JOURNAL_VERSION;
+	h.word_count = lex.size();
+
+	// earlier games stay for auditing, and for recovery if this one never
+	// gets going
+	size_t kept = 0;
+	if (access(path, F_OK) == 0) {
+		try {
+			kept = journal_reader(lex, path).length();
+		} catch (std::exception&) {
+			std::string aside = std::string(path) + ".old";
+			if (rename(path, aside.c_str()) != 0) {
+				throw std::runtime_error(std::string("Couldn't move ") + path +
+						" aside.");
+			}
+		}
+	}
+	fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw std::runtime_error(std::string("Couldn't open ") + path + ".");
+	}
+
+	// a new journal's header goes in with its first game, so there's never a
+	// journal without a beginning
+	if (kept == 0) {
+		record.assign(reinterpret_cast<char const*>(&h), sizeof(h));
+	}
+	put_varint(record, static_cast<uint64_t>(journal_record::begin));
+	put_varint(record, state.score);
+	put_ids(record, state.current);
+	put_ids(record, state.prior);
+	try {
+		if (kept != 0 && ftruncate(fd, kept) != 0) {
+			throw std::runtime_error(std::string("Couldn't trim ") + path + ".");
+		}
+		flush();
+	} catch (std::exception&) {
+		close(fd);
+		throw;
+	}
+}
+
+journal_writer::~journal_writer() {
+	if (fd >= 0) close(fd);
+}
+
+void journal_writer::put(uint64_t value) {
+	put_varint(record, value);
+}
+
+void journal_writer::flush() {
+	char const* p = record.data();
+	size_t left = record.size();
+	while (left > 0) {
+		ssize_t n = write(fd, p, left);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			throw std::runtime_error("Couldn't write to the journal.");
+		}
+		p += n;
+		left -= n;
+	}
+	record.clear();
+}
+
+void journal_writer::move(game_move const& m) {
+	put(static_cast<uint64_t>(journal_record::move));
+	put(m.chosen);
+	put(m.words.size());
+	for (word_id id : m.words) {
+		put(id);
+	}
+	flush();
+}
+
+void journal_writer::undo(size_t n) {
+	put(static_cast<uint64_t>(journal_record::undo));
+	put(n);
+	flush();
+}
+
+void journal_writer::redo(size_t n) {
+	put(static_cast<uint64_t>(journal_record::redo));
+	put(n);
+	flush();
+}
+
+journal_reader::journal_reader(lexicon const& lex, char const* path)
+	: file(path), game_count(0), last_game(0), whole(0), rewinds(false) {
+	if (file.size() < sizeof(journal_header)) {
+		throw std::runtime_error("Journal is truncated.");
+	}
+	journal_header const* header =
+		reinterpret_cast<journal_header const*>(file.data());
+	if (memcmp(header->magic, JOURNAL_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a journal.");
+	}
+	if (header->version != JOURNAL_VERSION) {
+		throw std::runtime_error("Journal version mismatch.");
+	}
+	if (header->word_count != lex.size()) {
+		throw std::runtime_error("Journal doesn't match the lexicon.");
+	}
+
+	// skims the records for where the last game begins and whether it undoes
+	// or redoes anything
+	char const* p = file.data() + sizeof(journal_header);
+	char const* end = file.data() + file.size();
+	uint64_t kind;
+	for (char const* at = p; skip_record(p, end, kind); at = p) {
+		if (kind == static_cast<uint64_t>(journal_record::begin)) {
+			game_count++;
+			last_game = at - file.data();
+			rewinds = false;
+		} else if (game_count == 0) {
+			throw std::runtime_error("Journal doesn't begin with a game.");
+		} else if (kind != static_cast<uint64_t>(journal_record::move)) {
+			rewinds = true;
+		}
+		whole = p - file.data();
+	}
+	if (game_count == 0) {
+		throw std::runtime_error("Journal doesn't begin with a game.");
+	}
+}
+
+// reads a set of IDs written by put_ids into out; false if the journal ends
+// first
+template<typename words> static bool get_ids(char const*& p,
+		char const* end, size_t word_count, words& out) {
+	uint64_t count, id = 0;
+	if (!get_varint(p, end, count)) return false;
+	for (uint64_t i = 0; i < count; i++) {
+		uint64_t gap;
+		if (!get_varint(p, end, gap)) return false;
+		id += gap;
+		if (id >= word_count) throw std::runtime_error("Journal is corrupt.");
+		out.insert(id);
+	}
+	return true;
+}
+
+replay_result journal_reader::replay(engine& rules) const {
+	lexicon const& lex = rules.words();
+	char const* p = file.data() + last_game;
+	char const* end = file.data() + file.size();
+
+	replay_result r;
+	r.moves = r.undos = r.redos = 0;
+	r.truncated = false;
+	uint64_t kind, value;
+	if (!get_varint(p, end, kind) ||
+			kind != static_cast<uint64_t>(journal_record::begin)) {
+		throw std::runtime_error("Journal doesn't begin with a game.");
+	}
+	if (!get_varint(p, end, value) ||
+			!get_ids(p, end, lex.size(), r.state.current) ||
+			!get_ids(p, end, lex.size(), r.state.prior)) {
+		throw std::runtime_error("Journal is truncated.");
+	}
+	r.state.score = value;
+	rules.restore_stems(r.state);
+	game_history history(r.state);
+
+	game_move m;
+	while (p != end) {
+		// a record is only applied once it has all been read
+		if (!get_varint(p, end, kind) || !get_varint(p, end, value)) {
+			r.truncated = true;
+			break;
+		}
+		if (kind == static_cast<uint64_t>(journal_record::move)) {
+			m.chosen = value;
+			uint64_t count, id;
+			bool whole = get_varint(p, end, count);
+			m.words.clear();
+			for (uint64_t i = 0; whole && i < count; i++) {
+				whole = get_varint(p, end, id);
+				m.words.push_back(id);
+				if (id >= lex.size()) value = no_word;
+			}
+			if (!whole) {
+				r.truncated = true;
+				break;
+			}
+			if (value >= lex.size()) {
+				throw std::runtime_error("Journal is corrupt.");
+			}
+			move_result result = rules.apply_move(r.state, m);
+			if (result.status != move_status::ok) {
+				char message[MAX_INPUT_LENGTH + 64];
+				snprintf(message, sizeof(message), move_message(result.status),
+						result.subject);
+				throw std::runtime_error("Journal move " +
+						std::to_string(r.moves + 1) + " was rejected: " + message);
+			}
+			if (rewinds) history.push(r.state);
+			r.moves++;
+		} else if (kind == static_cast<uint64_t>(journal_record::undo)) {
+			history.undo(value);
+			r.state = history.state();
+			r.undos++;
+		} else if (kind == static_cast<uint64_t>(journal_record::redo)) {
+			history.redo(value);
+			r.state = history.state();
+			r.redos++;
+		} else {
+			throw std::runtime_error("Journal is corrupt.");
+		}
+	}
+	return r;
+}
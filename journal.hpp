@@ -0,0 +1,101 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "game_history.hpp"
+#include "lexicon.hpp"
+#include "mapped_file.hpp"
+
+#define JOURNAL_FILE "rat_trap_parts.jnl"
+#define JOURNAL_MAGIC "RTP-JNL"
+#define JOURNAL_VERSION 1
+
+// on-disk layout: header, then records back to back.  Every game played
+// against the journal is kept, each from its begin record on, so it only
+// ever grows.  A record is a varint kind, then:
+//   begin: score, current count, current IDs, prior count, prior IDs, each set
+//          of IDs ascending and stored as gaps from the last
+//   move:  chosen ID, new word count, new word IDs
+//   undo, redo: how many moves
+// Varints are LEB128: 7 bits a byte, low bits first, high bit set on all but
+// the last byte.
+struct journal_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+};
+
+enum class journal_record : uint8_t {
+	begin,
+	move,
+	undo,
+	redo
+};
+
+// appends a game's moves to a journal as they're accepted.  Each record goes
+// out in a single write to a file opened for appending, so a crash loses at
+// most the record being written, and readers skip a partial last record.
+// Writing throws on failure, as when the disk is full.
+class journal_writer {
+	int fd;
+	std::string record;
+
+	void put(uint64_t value);
+	void flush();
+
+	public:
+	// begins a game at the end of the journal at path, from state: a new
+	// game's start word or a resumed game.  A partial last record left by a
+	// crash is cut off first; a journal lex can't read is moved aside to
+	// "<path>.old" and a new one started.
+	journal_writer(lexicon const& lex, game_state const& state,
+			char const* path = JOURNAL_FILE);
+	~journal_writer();
+	journal_writer(journal_writer const&) = delete;
+	journal_writer& operator= (journal_writer const&) = delete;
+
+	void move(game_move const& m);
+	void undo(size_t n);
+	void redo(size_t n);
+};
+
+struct replay_result {
+	// the game where the journal leaves it
+	game_state state;
+	uint64_t moves;
+	uint64_t undos;
+	uint64_t redos;
+	// true if the journal ends in a partial record, as after a crash
+	bool truncated;
+};
+
+// a journal mapped read-only, replayed through the engine.  Moves go in by ID,
+// so replay never parses text; every move is still checked against the rules,
+// and replay throws at the first one they reject.
+class journal_reader {
+	mapped_file file;
+	size_t game_count;
+	// offset of the last game's begin record
+	size_t last_game;
+	// bytes up to the end of the last whole record
+	size_t whole;
+	// true if the last game undoes or redoes anything.  Only then does replay
+	// keep every state, which would otherwise cost more than the moves.
+	bool rewinds;
+
+	public:
+	// throws unless path holds at least one game, journaled against lex
+	journal_reader(lexicon const& lex, char const* path = JOURNAL_FILE);
+
+	size_t games() const { return game_count; }
+	size_t length() const { return whole; }
+
+	// the last game in the journal, the one a crash would have cut short
+	replay_result replay(engine& rules) const;
+};
@@ -0,0 +1,108 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// per-letter counts of a word, one byte lane per letter a-z.  Lane 26 counts
+// anything that isn't a lowercase letter, so such input never compares equal
+// to a real word; the rest is padding out to 32 bytes, which is one AVX2 or two
+// SSE2 registers.  Loads are unaligned since histograms sit inside words,
+// parsed moves and vectors that don't align them to 32 bytes.
+struct letter_histogram {
+	uint8_t counts[32];
+
+	letter_histogram() { memset(counts, 0, sizeof(counts)); }
+	letter_histogram(char const* str, size_t len) {
+		memset(counts, 0, sizeof(counts));
+		add(str, len);
+	}
+
+	void add(char const* str, size_t len) {
+		for (size_t i = 0; i < len; i++) {
+			unsigned lane = static_cast<unsigned char>(str[i]) - 'a';
+			counts[lane < 26 ? lane : 26]++;
+		}
+	}
+
+	letter_histogram& operator+= (letter_histogram const& other) {
+#if defined(__AVX2__)
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(counts));
+		__m256i b = _mm256_loadu_si256(
+				reinterpret_cast<__m256i const*>(other.counts));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(counts),
+				_mm256_add_epi8(a, b));
+#elif defined(__SSE2__)
+		for (int half = 0; half < 32; half += 16) {
+			__m128i a = _mm_loadu_si128(
+					reinterpret_cast<__m128i const*>(counts + half));
+			__m128i b = _mm_loadu_si128(
+					reinterpret_cast<__m128i const*>(other.counts + half));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(counts + half),
+					_mm_add_epi8(a, b));
+		}
+#else
+		for (int i = 0; i < 32; i++) {
+			counts[i] += other.counts[i];
+		}
+#endif
+		return *this;
+	}
+
+	bool operator== (letter_histogram const& other) const {
+		return memcmp(counts, other.counts, sizeof(counts)) == 0;
+	}
+};
+
+const uint32_t letter_lanes = (1u << 26) - 1;
+
+// true if bigger holds exactly the letters of smaller plus one more: every lane
+// of bigger - smaller is 0 except a single letter lane that is 1.  Lanes where
+// smaller is larger wrap around to >= 255 and fail both tests.
+inline bool is_one_letter_more(letter_histogram const& bigger,
+		letter_histogram const& smaller) {
+#if defined(__AVX2__)
+	__m256i diff = _mm256_sub_epi8(
+			_mm256_loadu_si256(reinterpret_cast<__m256i const*>(bigger.counts)),
+			_mm256_loadu_si256(reinterpret_cast<__m256i const*>(smaller.counts)));
+	uint32_t zero = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(diff, _mm256_setzero_si256()));
+	uint32_t one = _mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(diff, _mm256_set1_epi8(1)));
+	return (zero | one) == 0xffffffffu && (one & ~letter_lanes) == 0 &&
+		one != 0 && (one & (one - 1)) == 0;
+#elif defined(__SSE2__)
+	uint32_t zero = 0;
+	uint32_t one = 0;
+	for (int half = 0; half < 32; half += 16) {
+		__m128i diff = _mm_sub_epi8(
+				_mm_loadu_si128(reinterpret_cast<__m128i const*>(bigger.counts + half)),
+				_mm_loadu_si128(
+					reinterpret_cast<__m128i const*>(smaller.counts + half)));
+		zero |= static_cast<uint32_t>(_mm_movemask_epi8(
+					_mm_cmpeq_epi8(diff, _mm_setzero_si128()))) << half;
+		one |= static_cast<uint32_t>(_mm_movemask_epi8(
+					_mm_cmpeq_epi8(diff, _mm_set1_epi8(1)))) << half;
+	}
+	return (zero | one) == 0xffffffffu && (one & ~letter_lanes) == 0 &&
+		one != 0 && (one & (one - 1)) == 0;
+#else
+	int ones = 0;
+	for (int i = 0; i < 32; i++) {
+		uint8_t diff = bigger.counts[i] - smaller.counts[i];
+		if (diff == 1 && i < 26) {
+			ones++;
+		} else if (diff != 0) {
+			return false;
+		}
+	}
+	return ones == 1;
+#endif
+}
@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+
+#include "lexicon.hpp"
+
+bool lowercase_and_validate(std::string& str) {
+	boost::algorithm::to_lower(str);
+	return std::all_of(str.begin(), str.end(), isalpha);
+}
+
+lexicon::lexicon(char const* path) : file(path) {
+	if (file.size() < sizeof(lexicon_header)) {
+		throw std::runtime_error("Lexicon snapshot is truncated.");
+	}
+	header = reinterpret_cast<lexicon_header const*>(file.data());
+	if (memcmp(header->magic, LEXICON_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a lexicon snapshot.");
+	}
+	if (header->version != LEXICON_VERSION) {
+		throw std::runtime_error("Lexicon snapshot version mismatch; rebuild it.");
+	}
+	size_t offsets_size = (header->word_count + 1) * sizeof(uint32_t);
+	if (file.size() != sizeof(lexicon_header) + offsets_size +
+			header->blob_size) {
+		throw std::runtime_error("Lexicon snapshot is truncated.");
+	}
+	offsets = reinterpret_cast<uint32_t const*>(file.data() +
+			sizeof(lexicon_header));
+	blob = file.data() + sizeof(lexicon_header) + offsets_size;
+}
+
+word_id lexicon::find(char const* str, size_t len) const {
+	// binary search over the sorted blob
+	word_id lo = 0;
+	word_id hi = header->word_count;
+	while (lo < hi) {
+		word_id mid = lo + (hi - lo) / 2;
+		char const* candidate = literal(mid);
+		size_t candidate_len = length(mid);
+		int cmp = memcmp(candidate, str, std::min(candidate_len, len));
+		if (cmp == 0) {
+			if (candidate_len == len) return mid;
+			cmp = candidate_len < len ? -1 : 1;
+		}
+		if (cmp < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return no_word;
+}
+
+void lexicon::write_snapshot(std::vector<std::string> const& words,
+		char const* path) {
+	lexicon_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, LEXICON_MAGIC, sizeof(h.magic));
+	h.version = LEXICON_VERSION;
+	h.word_count = words.size();
+
+	std::vector<uint32_t> offs;
+	std::string b;
+	for (auto const& w : words) {
+		offs.push_back(b.size());
+		b += w;
+		b += '\0';
+	}
+	offs.push_back(b.size());
+	h.blob_size = b.size();
+
+	std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+	out.append(reinterpret_cast<char const*>(offs.data()),
+			offs.size() * sizeof(uint32_t));
+	out += b;
+	write_file_atomic(path, out.data(), out.size());
+}
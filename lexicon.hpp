@@ -0,0 +1,76 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+#define LEXICON_SNAPSHOT "lexicon.bin"
+#define LEXICON_MAGIC "RTP-LEX"
+#define LEXICON_VERSION 1
+
+// shortest word the game accepts
+#define MIN_WORD_LENGTH 3
+
+// dense index of a word in the lexicon; words are numbered in sorted order
+typedef uint32_t word_id;
+const word_id no_word = UINT32_MAX;
+
+// contiguous run of IDs inside a snapshot
+template<typename T> struct id_range {
+	T const* first;
+	T const* last;
+
+	T const* begin() const { return first; }
+	T const* end() const { return last; }
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+};
+typedef id_range<word_id> word_range;
+
+// lowercases str in place; true if what's left is all letters
+bool lowercase_and_validate(std::string& str);
+
+// on-disk layout: header, word_count + 1 offsets into the blob, then the blob
+// of sorted, NUL-terminated lowercase words
+struct lexicon_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+	uint32_t blob_size;
+	uint32_t reserved;
+};
+
+// the expanded Hunspell dictionary, restricted to lowercase a-z words, mapped
+// read-only from a snapshot made by build_lexicon
+class lexicon {
+	mapped_file file;
+	lexicon_header const* header;
+	uint32_t const* offsets;
+	char const* blob;
+
+	public:
+	explicit lexicon(char const* path = LEXICON_SNAPSHOT);
+
+	size_t size() const { return header->word_count; }
+	char const* literal(word_id id) const { return blob + offsets[id]; }
+	size_t length(word_id id) const {
+		return offsets[id + 1] - offsets[id] - 1;
+	}
+
+	word_id find(char const* str, size_t len) const;
+	word_id find(std::string const& str) const {
+		return find(str.data(), str.size());
+	}
+	bool contains(std::string const& str) const {
+		return find(str) != no_word;
+	}
+
+	// words must already be sorted and unique
+	static void write_snapshot(std::vector<std::string> const& words,
+			char const* path);
+};
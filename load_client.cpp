@@ -0,0 +1,169 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Loads a running server with many sessions at once, each playing the games
+// in bench_games.txt over and over with one request in flight, and reports
+// throughput and per-request latency as a bench JSON line.
+// usage: load_client [socket] [sessions] [seconds]
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "bench.hpp"
+#include "game_server.hpp"
+
+#define LOAD_SESSIONS 1000
+#define LOAD_SECONDS 10
+#define LOAD_GAMES "bench_games.txt"
+#define LOAD_EVENTS 256
+
+// nothing here counts allocations
+std::atomic<uint64_t> bench_allocations(0);
+
+struct client {
+	int fd;
+	size_t game;
+	// the next move to send; before the first, the game's start
+	size_t move;
+	std::string in;
+	bench_clock::time_point sent;
+};
+
+static int connect_to(char const* path) {
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) {
+		throw std::runtime_error("Socket path is too long.");
+	}
+	strcpy(address.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address),
+				sizeof(address)) != 0) {
+		throw std::runtime_error(std::string("Couldn't connect to ") + path +
+				": " + strerror(errno));
+	}
+	return fd;
+}
+
+// requests are far smaller than the socket buffer, so a blocking send of one
+// never waits on the server
+static void send_next(client& c, std::vector<scripted_game> const& games) {
+	scripted_game const& g = games[c.game];
+	std::string request = c.move == 0 ? "start " + g.start :
+		"move " + g.moves[c.move - 1];
+	request += '\n';
+	c.sent = bench_clock::now();
+	if (send(c.fd, request.data(), request.size(), MSG_NOSIGNAL) !=
+			static_cast<ssize_t>(request.size())) {
+		throw std::runtime_error("Lost the server.");
+	}
+	if (++c.move > g.moves.size()) {
+		c.game = (c.game + 1) % games.size();
+		c.move = 0;
+	}
+}
+
+int main(int argc, char** argv) try {
+	if (argc > 4) {
+		fprintf(stderr, "usage: %s [socket] [sessions] [seconds]\n", argv[0]);
+		return 2;
+	}
+	char const* path = argc > 1 ? argv[1] : SERVER_SOCKET;
+	unsigned sessions = argc > 2 ? atoi(argv[2]) : LOAD_SESSIONS;
+	double seconds = argc > 3 ? atof(argv[3]) : LOAD_SECONDS;
+	if (sessions == 0) sessions = 1;
+
+	std::vector<scripted_game> games = read_games(LOAD_GAMES);
+	if (games.empty()) throw std::runtime_error("No games to play.");
+
+	rlimit files;
+	if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+	}
+
+	int poller = epoll_create1(EPOLL_CLOEXEC);
+	if (poller < 0) throw std::runtime_error("Couldn't make an epoll instance.");
+	std::vector<client> clients(sessions);
+	for (unsigned i = 0; i < sessions; i++) {
+		client& c = clients[i];
+		c.fd = connect_to(path);
+		// sessions start on different games so the server sees a mix
+		c.game = i % games.size();
+		c.move = 0;
+		epoll_event e;
+		memset(&e, 0, sizeof(e));
+		e.events = EPOLLIN;
+		e.data.u32 = i;
+		epoll_ctl(poller, EPOLL_CTL_ADD, c.fd, &e);
+	}
+
+	std::vector<double> latencies;
+	uint64_t rejected = 0;
+	bench_clock::time_point start = bench_clock::now();
+	for (client& c : clients) {
+		send_next(c, games);
+	}
+	epoll_event events[LOAD_EVENTS];
+	char buffer[4096];
+	while (seconds_since(start) < seconds) {
+		int n = epoll_wait(poller, events, LOAD_EVENTS, 100);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			throw std::runtime_error("epoll_wait failed.");
+		}
+		for (int i = 0; i < n; i++) {
+			client& c = clients[events[i].data.u32];
+			ssize_t got = read(c.fd, buffer, sizeof(buffer));
+			if (got <= 0) throw std::runtime_error("Lost the server.");
+			c.in.append(buffer, got);
+			size_t eol = c.in.find('\n');
+			if (eol == std::string::npos) continue;
+			latencies.push_back(std::chrono::duration<double, std::nano>(
+						bench_clock::now() - c.sent).count());
+			// the scripted games try some moves the rules reject
+			if (c.in.compare(0, 3, "err") == 0) rejected++;
+			c.in.erase(0, eol + 1);
+			send_next(c, games);
+		}
+	}
+	double elapsed = seconds_since(start);
+	for (client& c : clients) {
+		close(c.fd);
+	}
+	close(poller);
+	if (latencies.empty()) throw std::runtime_error("No replies in time.");
+
+	bench_result r;
+	r.name = "server/" + std::to_string(sessions) + "_sessions";
+	r.ops = latencies.size();
+	r.ns_per_op = elapsed * 1e9 / r.ops;
+	r.allocs_per_op = 0;
+	std::sort(latencies.begin(), latencies.end());
+	r.samples = latencies.size();
+	r.p50 = latencies[latencies.size() / 2];
+	r.p90 = latencies[latencies.size() * 9 / 10];
+	r.p99 = latencies[latencies.size() * 99 / 100];
+	r.max = latencies.back();
+	report(r);
+	fprintf(stderr, "%u sessions: %.0f requests/s, %llu rejected moves\n",
+			sessions, r.ops / elapsed, static_cast<unsigned long long>(rejected));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
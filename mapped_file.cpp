@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+mapped_file::mapped_file(char const* path) : addr(nullptr), length(0) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		throw std::runtime_error(std::string("Couldn't open ") + path + ".");
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::runtime_error(std::string("Couldn't stat ") + path + ".");
+	}
+	length = st.st_size;
+	if (length > 0) {
+		addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) {
+		throw std::runtime_error(std::string("Couldn't map ") + path + ".");
+	}
+}
+
+mapped_file::~mapped_file() {
+	if (addr != nullptr) {
+		munmap(addr, length);
+	}
+}
+
+void write_file_atomic(char const* path, void const* data, size_t size) {
+	std::string tmp_path = std::string(path) + ".tmp";
+	int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		throw std::runtime_error("Couldn't create " + tmp_path + ".");
+	}
+	char const* at = static_cast<char const*>(data);
+	while (size > 0) {
+		ssize_t written = write(fd, at, size);
+		if (written < 0) {
+			close(fd);
+			unlink(tmp_path.c_str());
+			throw std::runtime_error("Couldn't write " + tmp_path + ".");
+		}
+		at += written;
+		size -= written;
+	}
+	if (fsync(fd) != 0 || close(fd) != 0) {
+		unlink(tmp_path.c_str());
+		throw std::runtime_error("Couldn't flush " + tmp_path + ".");
+	}
+	if (rename(tmp_path.c_str(), path) != 0) {
+		unlink(tmp_path.c_str());
+		throw std::runtime_error(std::string("Couldn't replace ") + path + ".");
+	}
+}
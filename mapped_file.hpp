@@ -0,0 +1,25 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstddef>
+
+// read-only, private mapping of a whole file
+class mapped_file {
+	void* addr;
+	size_t length;
+
+	public:
+	explicit mapped_file(char const* path);
+	~mapped_file();
+	mapped_file(mapped_file const&) = delete;
+	mapped_file& operator= (mapped_file const&) = delete;
+
+	char const* data() const { return static_cast<char const*>(addr); }
+	size_t size() const { return length; }
+};
+
+// writes to "<path>.tmp" and renames over path, so readers never observe a
+// partially written file
+void write_file_atomic(char const* path, void const* data, size_t size);
@@ -0,0 +1,259 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "mcts.hpp"
+
+typedef std::chrono::steady_clock mcts_clock;
+
+namespace {
+
+struct node {
+	// the move that led here; unset at the root
+	game_move move;
+	uint32_t parent;
+	std::vector<uint32_t> children;
+	// moves not yet given a child.  Filled in stages, each only once the last
+	// is used up: first every current word's growths, which are cheap and
+	// score best, then one word's splits at a time.  A leaf visited once costs
+	// no move generation at all.
+	std::vector<game_move> untried;
+	// stages generated: 0 for none, 1 for the growths, 1 + i for word i's
+	// splits as well
+	uint32_t stage;
+	uint64_t visits;
+	// sum of the final scores of playouts through here
+	double total;
+	unsigned long best;
+
+	node() : parent(0), stage(0), visits(0), total(0), best(0) {}
+};
+
+// a move's statistics, pooled over the threads' trees
+struct pooled {
+	game_move move;
+	uint64_t visits;
+	double total;
+	unsigned long best;
+};
+
+// one thread's tree.  Rewards are scaled into [0, 1] by the worst and best
+// final scores seen, which are only known as the search goes, so nodes keep
+// raw score sums and are scaled when compared.
+struct tree {
+	lexicon const& lex;
+	move_generator gen;
+	mcts_options const& options;
+	std::mt19937_64 random;
+	std::vector<node> nodes;
+	unsigned long floor;
+	unsigned long ceiling;
+	// rollout scratch space
+	std::vector<game_move> moves;
+	std::vector<word_id> live;
+
+	tree(lexicon const& lex, anagram_index const& index,
+			successor_graph const& graph, stem_source& stems,
+			mcts_options const& options, uint64_t seed, position const& root)
+		: lex(lex), gen(lex, index, graph, stems), options(options), random(seed),
+		nodes(1), floor(root.value()), ceiling(root.value()) {}
+
+	double scaled(double score) const {
+		return ceiling == floor ? 0 : (score - floor) / (ceiling - floor);
+	}
+
+	// generates stages until some move turns up or there are none left; false
+	// if there were none
+	bool expand(uint32_t n, position const& p) {
+		node& e = nodes[n];
+		while (e.untried.empty() && e.stage <= p.current.size()) {
+			if (e.stage == 0) {
+				for (word_id w : p.current) {
+					gen.growths_from(w, p.used, e.untried);
+				}
+			} else {
+				gen.splits_from(p.current[e.stage - 1], p.used, e.untried);
+			}
+			e.stage++;
+			std::shuffle(e.untried.begin(), e.untried.end(), random);
+		}
+		return !e.untried.empty();
+	}
+
+	// the child with the highest upper confidence bound
+	uint32_t select(uint32_t n) const {
+		double log_visits = std::log(static_cast<double>(nodes[n].visits));
+		uint32_t choice = nodes[n].children.front();
+		double most = -1;
+		for (uint32_t c : nodes[n].children) {
+			node const& child = nodes[c];
+			double ucb = scaled(child.total / child.visits) + options.exploration *
+				std::sqrt(log_visits / child.visits);
+			if (ucb > most) {
+				most = ucb;
+				choice = c;
+			}
+		}
+		return choice;
+	}
+
+	// plays p out by the rollout policy and returns the final score.  A word
+	// with no moves never gets one back, since stems are only ever used up, so
+	// it is dropped for the rest of the rollout.
+	unsigned long rollout(position& p) {
+		live = p.current;
+		for (unsigned made = 0; !live.empty() &&
+				(options.rollout_moves == 0 || made < options.rollout_moves); ) {
+			size_t i = random() % live.size();
+			moves.clear();
+			// a growth always outscores a split, and enumerating a long word's
+			// splits costs milliseconds, so greedy rollouts only grow words and
+			// leave splitting to the tree
+			if (options.rollout == rollout_policy::greedy) {
+				gen.growths_from(live[i], p.used, moves);
+			} else {
+				gen.moves_from(live[i], p.used, moves);
+			}
+			live[i] = live.back();
+			live.pop_back();
+			if (moves.empty()) continue;
+
+			size_t pick = random() % moves.size();
+			if (options.rollout == rollout_policy::greedy) {
+				// the best scoring, ties broken at random from the random start
+				for (size_t j = 0; j < moves.size(); j++) {
+					size_t k = (pick + j) % moves.size();
+					if (moves[k].points > moves[pick].points) pick = k;
+				}
+			}
+			p.apply(lex, moves[pick]);
+			live.insert(live.end(), moves[pick].words.begin(),
+					moves[pick].words.end());
+			made++;
+		}
+		return p.value();
+	}
+
+	void playout(position const& root) {
+		position p = root;
+		uint32_t n = 0;
+		for (;;) {
+			// the root's first move comes from the search, not a rollout
+			if ((n == 0 || nodes[n].visits > 0) && expand(n, p)) {
+				node child;
+				child.move = std::move(nodes[n].untried.back());
+				child.parent = n;
+				nodes[n].untried.pop_back();
+				p.apply(lex, child.move);
+				nodes.push_back(std::move(child));
+				uint32_t c = nodes.size() - 1;
+				nodes[n].children.push_back(c);
+				n = c;
+				break;
+			}
+			// a leaf: either new, or the end of the game
+			if (nodes[n].children.empty()) break;
+			n = select(n);
+			p.apply(lex, nodes[n].move);
+		}
+
+		unsigned long score = rollout(p);
+		floor = std::min(floor, score);
+		ceiling = std::max(ceiling, score);
+		for (uint32_t i = n; ; i = nodes[i].parent) {
+			nodes[i].visits++;
+			nodes[i].total += score;
+			nodes[i].best = std::max(nodes[i].best, score);
+			if (i == 0) break;
+		}
+	}
+};
+
+}
+
+mcts_advice mcts::search(position const& from, mcts_options const& options) {
+	size_t threads = options.threads;
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	if (!stems.is_baked()) threads = 1;
+	uint64_t max_playouts = options.max_playouts;
+	if (max_playouts == 0 && options.time_limit == 0) {
+		max_playouts = MCTS_DEFAULT_PLAYOUTS;
+	}
+	uint64_t seed = options.seed != 0 ? options.seed : std::random_device()();
+
+	mcts_clock::time_point start = mcts_clock::now();
+	mcts_clock::time_point deadline = start + std::chrono::duration_cast<
+		mcts_clock::duration>(std::chrono::duration<double>(options.time_limit));
+	std::atomic<uint64_t> playouts(0);
+	std::vector<std::unique_ptr<tree> > trees;
+	for (size_t i = 0; i < threads; i++) {
+		trees.emplace_back(new tree(lex, index, graph, stems, options, seed + i,
+					from));
+	}
+	auto work = [&] (tree* t) {
+		while ((max_playouts == 0 || playouts++ < max_playouts) &&
+				(options.time_limit == 0 || mcts_clock::now() < deadline)) {
+			t->playout(from);
+			// nothing to search from a finished game
+			if (t->nodes[0].children.empty()) break;
+		}
+	};
+	std::vector<std::thread> pool;
+	for (size_t i = 1; i < threads; i++) {
+		pool.emplace_back(work, trees[i].get());
+	}
+	work(trees[0].get());
+	for (auto& t : pool) {
+		t.join();
+	}
+	double elapsed = std::chrono::duration<double>(mcts_clock::now() -
+			start).count();
+
+	// pool the root's children across trees, matching moves by their words
+	std::map<std::vector<word_id>, pooled> root;
+	uint64_t total = 0;
+	for (auto const& t : trees) {
+		total += t->nodes[0].visits;
+		for (uint32_t c : t->nodes[0].children) {
+			node const& child = t->nodes[c];
+			std::vector<word_id> key(1, child.move.chosen);
+			key.insert(key.end(), child.move.words.begin(), child.move.words.end());
+			auto it = root.find(key);
+			if (it == root.end()) {
+				pooled p = { child.move, 0, 0, 0 };
+				it = root.insert(std::make_pair(key, p)).first;
+			}
+			it->second.visits += child.visits;
+			it->second.total += child.total;
+			it->second.best = std::max(it->second.best, child.best);
+		}
+	}
+
+	mcts_advice advice;
+	advice.found = false;
+	advice.best_score = from.value();
+	advice.mean_score = from.value();
+	advice.playouts = total;
+	advice.playouts_per_second = elapsed > 0 ? total / elapsed : 0;
+	uint64_t most = 0;
+	for (auto const& entry : root) {
+		pooled const& p = entry.second;
+		if (p.visits > most) {
+			most = p.visits;
+			advice.found = true;
+			advice.best = p.move;
+			advice.best_score = p.best;
+			advice.mean_score = p.total / p.visits;
+		}
+	}
+	return advice;
+}
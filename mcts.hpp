@@ -0,0 +1,81 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "lexicon.hpp"
+#include "move_generator.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+
+enum class rollout_policy {
+	// a uniformly random move from a random current word
+	random,
+	// the best scoring growth of a random current word.  Splits score less
+	// than growths and are costly to list, so greedy rollouts never split;
+	// the tree still does.
+	greedy
+};
+
+#define MCTS_DEFAULT_PLAYOUTS 10000
+#define MCTS_ROLLOUT_MOVES 20
+
+struct mcts_options {
+	// stop after this many seconds; 0 for no limit
+	double time_limit;
+	// stop after this many playouts in all; 0 for no limit.  With neither
+	// limit set, search() stops after MCTS_DEFAULT_PLAYOUTS.
+	uint64_t max_playouts;
+	// worker threads, each growing its own tree; 0 for one per core.  The live
+	// stemmer isn't thread-safe, so without baked stems there is one.
+	unsigned threads;
+	// UCT's exploration constant, against rewards scaled to [0, 1]
+	double exploration;
+	rollout_policy rollout;
+	// stop a rollout after this many moves and score it as if the game ended
+	// there; 0 to play to the end, which on the full lexicon can take
+	// thousands of moves
+	unsigned rollout_moves;
+	uint64_t seed;
+
+	mcts_options() : time_limit(1), max_playouts(0), threads(0),
+		exploration(1.4), rollout(rollout_policy::greedy),
+		rollout_moves(MCTS_ROLLOUT_MOVES), seed(0) {}
+};
+
+struct mcts_advice {
+	// false if there are no legal moves
+	bool found;
+	// the most visited move from the position
+	game_move best;
+	// the best final score a playout through that move reached
+	unsigned long best_score;
+	// mean final score of playouts through that move
+	double mean_score;
+	uint64_t playouts;
+	double playouts_per_second;
+};
+
+// Monte Carlo tree search for the move to make from a position, for games too
+// big to search exhaustively.  Each thread grows its own tree from the
+// position by UCT, and the trees' root visit counts are pooled at the end
+// (root parallelism).  Anytime: stops when its time or playout budget runs
+// out and returns the best move found so far.
+class mcts {
+	lexicon const& lex;
+	anagram_index const& index;
+	successor_graph const& graph;
+	stem_source& stems;
+
+	public:
+	mcts(lexicon const& lex, anagram_index const& index,
+			successor_graph const& graph, stem_source& stems)
+		: lex(lex), index(index), graph(graph), stems(stems) {}
+
+	mcts_advice search(position const& from,
+			mcts_options const& options = mcts_options());
+};
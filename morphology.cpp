@@ -0,0 +1,126 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "morphology.hpp"
+
+static char const* const index_files[parts_of_speech] = {
+	"index.noun", "index.verb", "index.adj", "index.adv"
+};
+static char const* const exception_files[parts_of_speech] = {
+	"noun.exc", "verb.exc", "adj.exc", "adv.exc"
+};
+
+// morph.c's detachment rules: a word ending in suffix may be a lemma ending
+// in ending instead, tried in order.  Adverbs have only their exceptions.
+struct detachment {
+	char const* suffix;
+	char const* ending;
+};
+
+static detachment const noun_rules[] = {
+	{ "s", "" }, { "ses", "s" }, { "xes", "x" }, { "zes", "z" },
+	{ "ches", "ch" }, { "shes", "sh" }, { "men", "man" }, { "ies", "y" }
+};
+static detachment const verb_rules[] = {
+	{ "s", "" }, { "ies", "y" }, { "es", "e" }, { "es", "" },
+	{ "ed", "e" }, { "ed", "" }, { "ing", "e" }, { "ing", "" }
+};
+static detachment const adjective_rules[] = {
+	{ "er", "" }, { "est", "" }, { "er", "e" }, { "est", "e" }
+};
+
+struct rule_range {
+	detachment const* begin;
+	detachment const* end;
+};
+
+static rule_range const rules[parts_of_speech] = {
+	{ std::begin(noun_rules), std::end(noun_rules) },
+	{ std::begin(verb_rules), std::end(verb_rules) },
+	{ std::begin(adjective_rules), std::end(adjective_rules) },
+	{ nullptr, nullptr }
+};
+
+static bool ends_with(std::string const& str, char const* suffix) {
+	size_t n = strlen(suffix);
+	return str.size() >= n && str.compare(str.size() - n, n, suffix) == 0;
+}
+
+static std::string database_dir(char const* dir) {
+	if (dir != nullptr) return dir;
+	if (char const* search = getenv("WNSEARCHDIR")) return search;
+	if (char const* home = getenv("WNHOME")) return std::string(home) + "/dict";
+	return WORDNET_DIR;
+}
+
+morphology::morphology(char const* dir) {
+	std::string path = database_dir(dir) + "/";
+	std::string line;
+	for (int pos = noun; pos < parts_of_speech; pos++) {
+		std::ifstream index(path + index_files[pos]);
+		if (!index) {
+			throw std::runtime_error("Couldn't read " + path +
+					index_files[pos] + ".");
+		}
+		while (std::getline(index, line)) {
+			// the license at the top is indented
+			if (line.empty() || line[0] == ' ') continue;
+			lemmas[pos].insert(line.substr(0, line.find(' ')));
+		}
+
+		// as for WordNet, a part of speech may have no exceptions
+		std::ifstream exc(path + exception_files[pos]);
+		while (std::getline(exc, line)) {
+			size_t end = line.find(' ');
+			if (end == std::string::npos) continue;
+			size_t base = line.find_first_not_of(' ', end);
+			if (base == std::string::npos) continue;
+			// later lines for the same form don't replace the first, which is
+			// the one WordNet's binary search finds in a sorted file
+			exceptions[pos].emplace(line.substr(0, end),
+					line.substr(base, line.find(' ', base) - base));
+		}
+	}
+}
+
+bool morphology::base_form(std::string const& word, part_of_speech pos,
+		std::string& base) const {
+	auto e = exceptions[pos].find(word);
+	if (e != exceptions[pos].end()) {
+		base = e->second;
+		return true;
+	}
+	if (pos == adverb) return false;
+
+	// nouns ending in "ful" are looked up without it and get it back
+	std::string stem = word;
+	char const* end = "";
+	if (pos == noun) {
+		if (ends_with(word, "ful")) {
+			stem = word.substr(0, word.rfind('f'));
+			if (stem.empty()) stem = word;
+			end = "ful";
+		} else if (ends_with(word, "ss") || word.size() <= 2) {
+			return false;
+		}
+	}
+
+	std::string candidate;
+	for (detachment const* r = rules[pos].begin; r != rules[pos].end; r++) {
+		if (!ends_with(stem, r->suffix)) continue;
+		candidate.assign(stem, 0, stem.size() - strlen(r->suffix));
+		candidate += r->ending;
+		if (candidate != stem && defined(candidate, pos)) {
+			base = candidate + end;
+			return true;
+		}
+	}
+	return false;
+}
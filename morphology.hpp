@@ -0,0 +1,47 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// where WordNet installs its database when neither WNSEARCHDIR nor WNHOME
+// says otherwise
+#define WORDNET_DIR "/usr/local/WordNet-3.0/dict"
+
+enum part_of_speech {
+	noun,
+	verb,
+	adjective,
+	adverb,
+	parts_of_speech
+};
+
+// WordNet's morphword() and in_wn(), for single lowercase words, over tables
+// loaded once from the database and never changed after, so any number of
+// threads can ask at once.  WordNet's own answers come out of static buffers
+// and shared file handles, one thread at a time.
+class morphology {
+	// every lemma in index.<pos>
+	std::unordered_set<std::string> lemmas[parts_of_speech];
+	// each inflected form in <pos>.exc and its first base form
+	std::unordered_map<std::string, std::string> exceptions[parts_of_speech];
+
+	public:
+	// loads from dir, or when it's null from where WordNet would look:
+	// WNSEARCHDIR, then WNHOME/dict, then WORDNET_DIR
+	explicit morphology(char const* dir = nullptr);
+
+	// in_wn(): whether word is a lemma of pos
+	bool defined(std::string const& word, part_of_speech pos) const {
+		return lemmas[pos].count(word) != 0;
+	}
+
+	// morphword(): word's base form as pos, from the exceptions or else the
+	// first suffix rule giving a lemma.  False where morphword() gives null,
+	// as for a word that's already a base form.
+	bool base_form(std::string const& word, part_of_speech pos,
+			std::string& base) const;
+};
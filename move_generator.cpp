@@ -0,0 +1,120 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include "move_generator.hpp"
+
+std::string move_text(lexicon const& lex, game_move const& m) {
+	std::string text = lex.literal(m.chosen);
+	for (word_id w : m.words) {
+		text += ' ';
+		text += lex.literal(w);
+	}
+	return text;
+}
+
+position::position(word_id start, stem_range stems, size_t stem_count)
+	: used(stem_count), score(0), bonus(0), hash(zobrist_word(start)) {
+	current.push_back(start);
+	used.insert(stems.begin(), stems.end());
+	for (stem_id s : stems) {
+		hash ^= zobrist_stem(s);
+	}
+}
+
+void position::apply(lexicon const& lex, game_move const& m) {
+	auto it = std::find(current.begin(), current.end(), m.chosen);
+	*it = current.back();
+	current.pop_back();
+	bonus -= lex.length(m.chosen) - 3;
+	hash ^= zobrist_word(m.chosen);
+	for (word_id w : m.words) {
+		current.push_back(w);
+		bonus += lex.length(w) - 3;
+		hash ^= zobrist_word(w);
+	}
+	used.insert(m.stems.begin(), m.stems.end());
+	for (stem_id s : m.stems) {
+		hash ^= zobrist_stem(s);
+	}
+	score += m.points;
+}
+
+void position::undo(lexicon const& lex, game_move const& m) {
+	for (stem_id s : m.stems) {
+		used.erase(s);
+		hash ^= zobrist_stem(s);
+	}
+	for (word_id w : m.words) {
+		current.erase(std::find(current.begin(), current.end(), w));
+		bonus -= lex.length(w) - 3;
+		hash ^= zobrist_word(w);
+	}
+	current.push_back(m.chosen);
+	bonus += lex.length(m.chosen) - 3;
+	hash ^= zobrist_word(m.chosen);
+	score -= m.points;
+}
+
+void move_generator::moves_from(word_id chosen, stem_set const& used,
+		std::vector<game_move>& out) {
+	growths_from(chosen, used, out);
+	splits_from(chosen, used, out);
+}
+
+void move_generator::splits_from(word_id chosen, stem_set const& used,
+		std::vector<game_move>& out) {
+	letters.assign(lex.literal(chosen), lex.length(chosen));
+	game_move m;
+	m.chosen = chosen;
+	for (char c = 'a'; c <= 'z'; c++) {
+		splits.for_each(letters, c, [&] (split const& s) {
+			// growths_from's business
+			if (s.size() == 1) return true;
+			m.points = 0;
+			m.stems.clear();
+			for (word_id w : s) {
+				stem_range r = stems.stems(w);
+				if (r.empty()) return true;
+				for (stem_id stem : r) {
+					if (used.contains(stem) ||
+							std::find(m.stems.begin(), m.stems.end(), stem) !=
+							m.stems.end()) {
+						return true;
+					}
+					m.stems.push_back(stem);
+				}
+				m.points += lex.length(w) - 3;
+			}
+			m.words = s;
+			out.push_back(m);
+			return true;
+		});
+	}
+}
+
+void move_generator::growths_from(word_id chosen, stem_set const& used,
+		std::vector<game_move>& out) {
+	game_move m;
+	m.chosen = chosen;
+	for (word_id w : graph.successors(chosen)) {
+		stem_range r = stems.stems(w);
+		if (r.empty() || std::any_of(r.begin(), r.end(),
+					[&] (stem_id s) { return used.contains(s); })) {
+			continue;
+		}
+		m.words.assign(1, w);
+		m.points = lex.length(w) - 3;
+		m.stems.assign(r.begin(), r.end());
+		out.push_back(m);
+	}
+}
+
+void move_generator::moves(std::vector<word_id> const& current,
+		stem_set const& used, std::vector<game_move>& out) {
+	for (word_id w : current) {
+		moves_from(w, used, out);
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "lexicon.hpp"
+#include "split_enumerator.hpp"
+#include "stem_set.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+#include "transposition_table.hpp"
+
+// one step of the game: chosen is replaced by words, which together spell
+// chosen plus one letter
+struct game_move {
+	word_id chosen;
+	std::vector<word_id> words;
+	// what the move scores: each new word's length minus 3
+	unsigned long points;
+	// every stem the new words claim
+	std::vector<stem_id> stems;
+};
+
+// "<chosen> <words...>", as a player would type it
+std::string move_text(lexicon const& lex, game_move const& m);
+
+// a game position as the searches see it, by ID, mutated in place by moves
+// and restored by undoing them in reverse order
+struct position {
+	std::vector<word_id> current;
+	stem_set used;
+	// points scored by moves so far
+	unsigned long score;
+	// what the current words add at the end of the game
+	unsigned long bonus;
+	// Zobrist hash of current and used
+	uint64_t hash;
+
+	position() : score(0), bonus(0), hash(0) {}
+	// start is the start word and stems its stems
+	position(word_id start, stem_range stems, size_t stem_count);
+
+	// the score if the game ended here
+	unsigned long value() const { return score + bonus; }
+
+	void apply(lexicon const& lex, game_move const& m);
+	void undo(lexicon const& lex, game_move const& m);
+};
+
+// lists legal moves under the real rules: every single-word and split move,
+// with stems checked against the used set and against each other.  Keeps a
+// split_enumerator, so it is not thread-safe; use one per thread.
+class move_generator {
+	lexicon const& lex;
+	successor_graph const& graph;
+	stem_source& stems;
+	split_enumerator splits;
+	std::string letters;
+
+	public:
+	move_generator(lexicon const& lex, anagram_index const& index,
+			successor_graph const& graph, stem_source& stems)
+		: lex(lex), graph(graph), stems(stems), splits(index) {}
+
+	// appends the legal moves that replace chosen
+	void moves_from(word_id chosen, stem_set const& used,
+			std::vector<game_move>& out);
+	// appends only the single-word moves that replace chosen.  These always
+	// outscore splits, and are cheap: a long word can have thousands of
+	// splits, but only a handful of growths, read from the successor graph.
+	void growths_from(word_id chosen, stem_set const& used,
+			std::vector<game_move>& out);
+	// appends only the moves that split chosen into two or more words
+	void splits_from(word_id chosen, stem_set const& used,
+			std::vector<game_move>& out);
+	// appends the legal moves from every current word
+	void moves(std::vector<word_id> const& current, stem_set const& used,
+			std::vector<game_move>& out);
+
+	split_enumerator& split_cache() { return splits; }
+};
@@ -0,0 +1,77 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstddef>
+
+#include <boost/utility/string_ref.hpp>
+
+#include "letter_histogram.hpp"
+#include "lexicon.hpp"
+
+#define MAX_INPUT_LENGTH 128
+// new words kept from one move: as many as fit in the input at their
+// shortest, plus the one that stops the parse
+#define MAX_MOVE_WORDS (MAX_INPUT_LENGTH / (MIN_WORD_LENGTH + 1) + 1)
+
+struct move_token {
+	boost::string_ref text;
+	letter_histogram histogram;
+};
+
+// a move as typed, "<current word> <new words separated by spaces>", taken
+// apart in one pass over the input with no allocation.  Tokens point into
+// text, so the whole struct is kept while they're used.
+struct parsed_move {
+	// the input, lowercased
+	char text[MAX_INPUT_LENGTH];
+	move_token chosen;
+	move_token words[MAX_MOVE_WORDS];
+	size_t word_count;
+	// all of words together
+	letter_histogram words_histogram;
+	// true if a new word isn't all letters or is too short.  Parsing keeps
+	// no words after it, so it's the last of words.
+	bool malformed;
+};
+
+// splits input at every space, as strsep() would, so doubled spaces make
+// empty, malformed words.  False if input is MAX_INPUT_LENGTH or longer.
+inline bool parse_move(char const* input, parsed_move& move) {
+	move.word_count = 0;
+	move.words_histogram = letter_histogram();
+	move.malformed = false;
+
+	move_token* token = &move.chosen;
+	token->histogram = letter_histogram();
+	size_t start = 0;
+	bool letters = true;
+	for (size_t i = 0; ; i++) {
+		char c = input[i];
+		if (c != '\0' && i + 1 >= MAX_INPUT_LENGTH) return false;
+		if (c != '\0' && c != ' ') {
+			if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+			move.text[i] = c;
+			if (token != nullptr) token->histogram.add(&c, 1);
+			letters = letters && c >= 'a' && c <= 'z';
+			continue;
+		}
+
+		// past a malformed word only the length is still checked
+		if (token != nullptr) {
+			token->text = boost::string_ref(move.text + start, i - start);
+			if (token != &move.chosen) {
+				move.word_count++;
+				move.words_histogram += token->histogram;
+				move.malformed = !letters || token->text.size() < MIN_WORD_LENGTH;
+			}
+		}
+		if (c == '\0') return true;
+		move.text[i] = ' ';
+		start = i + 1;
+		letters = true;
+		token = move.malformed ? nullptr : &move.words[move.word_count];
+		if (token != nullptr) token->histogram = letter_histogram();
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "ncurses_wrappers.hpp"
+
+// lays words out in rows of at most MAX_COLS, size rows to a page.  from is a
+// word_set or persistent_bitset of IDs into lex.
+template<size_t size, typename words> void paginate(lexicon const& lex,
+		words const& from, std::vector<std::array<std::string, size> >& to) {
+	to.clear();
+	to.emplace_back();
+	std::string row;
+	int row_index = 0;
+	from.for_each([&] (word_id id) {
+		if (row.size() + lex.length(id) >= MAX_COLS) {
+			if (row_index == size) {
+				to.emplace_back();
+				row_index = 0;
+			}
+			to.back()[row_index++] = row;
+			row.clear();
+		}
+		row.append(lex.literal(id), lex.length(id));
+		row += ' ';
+	});
+	if (row.size() > 0) {
+		if (row_index == size) {
+			to.emplace_back();
+			row_index = 0;
+		}
+		to.back()[row_index++] = row;
+	}
+}
@@ -0,0 +1,114 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include "persistent_bitset.hpp"
+
+persistent_bitset::persistent_bitset(uint64_t const* words, size_t n)
+	: height(0), count(0) {
+	while (span(height) < n * 64) {
+		height++;
+	}
+	root = build(words, n, height, 0);
+}
+
+// the subtree of height h whose first word is words[first]; null if it's all
+// zeros
+std::shared_ptr<void const> persistent_bitset::build(uint64_t const* words,
+		size_t n, unsigned h, size_t first) {
+	if (h == 0) {
+		size_t last = std::min<size_t>(first + PERSISTENT_LEAF_WORDS, n);
+		if (std::all_of(words + first, words + last,
+					[] (uint64_t w) { return w == 0; })) {
+			return nullptr;
+		}
+		std::shared_ptr<leaf> l = std::make_shared<leaf>();
+		for (size_t i = first; i < last; i++) {
+			l->bits[i - first] = words[i];
+			count += __builtin_popcountll(words[i]);
+		}
+		return l;
+	}
+	std::shared_ptr<inner> node;
+	size_t child_words = span(h - 1) / 64;
+	for (unsigned i = 0; i < PERSISTENT_FANOUT &&
+			first + i * child_words < n; i++) {
+		std::shared_ptr<void const> child = build(words, n, h - 1,
+				first + i * child_words);
+		if (!child) continue;
+		if (!node) node = std::make_shared<inner>();
+		node->children[i] = child;
+	}
+	return node;
+}
+
+void persistent_bitset::flatten(void const* node, unsigned h, uint64_t* words,
+		size_t n, size_t first) {
+	if (node == nullptr || first >= n) return;
+	if (h == 0) {
+		leaf const* l = static_cast<leaf const*>(node);
+		size_t last = std::min<size_t>(first + PERSISTENT_LEAF_WORDS, n);
+		std::copy(l->bits, l->bits + (last - first), words + first);
+		return;
+	}
+	inner const* in = static_cast<inner const*>(node);
+	size_t child_words = span(h - 1) / 64;
+	for (unsigned i = 0; i < PERSISTENT_FANOUT; i++) {
+		flatten(in->children[i].get(), h - 1, words, n,
+				first + i * child_words);
+	}
+}
+
+void persistent_bitset::to_words(uint64_t* words, size_t n) const {
+	std::fill(words, words + n, 0);
+	flatten(root.get(), height, words, n, 0);
+}
+
+bool persistent_bitset::contains(uint32_t id) const {
+	if (id >= span(height)) return false;
+	void const* node = root.get();
+	for (unsigned h = height; node != nullptr && h > 0; h--) {
+		uint64_t child_span = span(h - 1);
+		node = static_cast<inner const*>(node)->children[id / child_span].get();
+		id %= child_span;
+	}
+	if (node == nullptr) return false;
+	uint64_t word = static_cast<leaf const*>(node)->bits[id / 64];
+	return (word >> (id % 64) & 1) != 0;
+}
+
+// a copy of node with id set, sharing every untouched child
+std::shared_ptr<void const> persistent_bitset::with(
+		std::shared_ptr<void const> const& node, unsigned h, uint64_t id) {
+	if (h == 0) {
+		std::shared_ptr<leaf> l = node ?
+			std::make_shared<leaf>(*static_cast<leaf const*>(node.get())) :
+			std::make_shared<leaf>();
+		l->bits[id / 64] |= uint64_t(1) << (id % 64);
+		return l;
+	}
+	std::shared_ptr<inner> n = node ?
+		std::make_shared<inner>(*static_cast<inner const*>(node.get())) :
+		std::make_shared<inner>();
+	uint64_t child_span = span(h - 1);
+	std::shared_ptr<void const>& child = n->children[id / child_span];
+	child = with(child, h - 1, id % child_span);
+	return n;
+}
+
+void persistent_bitset::insert(uint32_t id) {
+	while (id >= span(height)) {
+		// the old trie becomes the first child of a new root
+		if (root) {
+			std::shared_ptr<inner> grown = std::make_shared<inner>();
+			grown->children[0] = root;
+			root = grown;
+		}
+		height++;
+	}
+	if (contains(id)) return;
+	root = with(root, height, id);
+	count++;
+}
@@ -0,0 +1,94 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <memory>
+
+// children of an inner node, and 64-bit words of a leaf
+#define PERSISTENT_FANOUT 16
+#define PERSISTENT_LEAF_WORDS 16
+
+// set of small integers (word or stem IDs) as a bitset in a trie of
+// immutable, shared nodes.  Inserting copies only the path down to the
+// changed leaf, so copying a set copies one pointer and earlier copies never
+// change: keeping every version costs O(log n) nodes per insert, not a whole
+// bitset.  All-zero subtrees are null, and the trie grows a level whenever an
+// ID outgrows it.
+class persistent_bitset {
+	struct leaf {
+		uint64_t bits[PERSISTENT_LEAF_WORDS];
+
+		leaf() : bits() {}
+	};
+	struct inner {
+		// leaf or inner, by height
+		std::shared_ptr<void const> children[PERSISTENT_FANOUT];
+	};
+
+	std::shared_ptr<void const> root;
+	// 0 when root is a leaf
+	unsigned height;
+	size_t count;
+
+	// IDs a subtree of height h covers
+	static uint64_t span(unsigned h) {
+		uint64_t n = PERSISTENT_LEAF_WORDS * 64;
+		for (; h > 0; h--) {
+			n *= PERSISTENT_FANOUT;
+		}
+		return n;
+	}
+
+	static std::shared_ptr<void const> with(
+			std::shared_ptr<void const> const& node, unsigned h, uint64_t id);
+	std::shared_ptr<void const> build(uint64_t const* words, size_t n,
+			unsigned h, size_t first);
+	static void flatten(void const* node, unsigned h, uint64_t* words,
+			size_t n, size_t first);
+
+	template<typename F> static void visit(void const* node, unsigned h,
+			uint64_t first, F& f) {
+		if (node == nullptr) return;
+		if (h == 0) {
+			leaf const* l = static_cast<leaf const*>(node);
+			for (unsigned i = 0; i < PERSISTENT_LEAF_WORDS; i++) {
+				for (uint64_t b = l->bits[i]; b != 0; b &= b - 1) {
+					f(static_cast<uint32_t>(first + i * 64 +
+								__builtin_ctzll(b)));
+				}
+			}
+			return;
+		}
+		inner const* n = static_cast<inner const*>(node);
+		uint64_t child_span = span(h - 1);
+		for (unsigned i = 0; i < PERSISTENT_FANOUT; i++) {
+			visit(n->children[i].get(), h - 1, first + i * child_span, f);
+		}
+	}
+
+	public:
+	persistent_bitset() : height(0), count(0) {}
+	// the plain bitset words[0, n), built leaf by leaf rather than bit by bit
+	persistent_bitset(uint64_t const* words, size_t n);
+
+	bool contains(uint32_t id) const;
+	void insert(uint32_t id);
+	template<typename It> void insert(It first, It last) {
+		for (; first != last; ++first) {
+			insert(*first);
+		}
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	// writes the set as a plain bitset of n words, dropping IDs past its end
+	void to_words(uint64_t* words, size_t n) const;
+
+	// calls f with each ID, in increasing order
+	template<typename F> void for_each(F f) const {
+		visit(root.get(), height, 0, f);
+	}
+};
@@ -9,138 +9,24 @@
 #include <random>
 #include <sstream>
 
-#include <boost/algorithm/string.hpp>
-using namespace boost::algorithm;
-
-#include <wn.h> // for in_wn and morphword
-
 #include "rat_trap_parts.hpp"
 #include "ncurses_wrappers.hpp"
-
-#define HUNSPELL_AFF "en_US.aff"
-#define HUNSPELL_DIC "en_US.dic"
+#include "paginate.hpp"
+#include "saved_game.hpp"
 
 #define SCORE_STR "Score:"
 #define FINAL_SCORE_STR "Your final score is "
 #define PRIOR_WORDS_STR "Prior words:"
 #define CURRENT_WORDS_STR "Current words:"
 #define PROMPT_STR ">"
+// how long the advisor thinks for
+#define ADVISOR_SECONDS 1.0
 
 const static std::string prior_words_row(std::string(PRIOR_WORDS_STR) +
 		std::string(MAX_COLS - strlen(PRIOR_WORDS_STR), ' '));
 const static std::string current_words_row(std::string(CURRENT_WORDS_STR) +
 		std::string(MAX_COLS - strlen(CURRENT_WORDS_STR), ' '));
 
-bool lowercase_and_validate(std::string& str) {
-	to_lower(str);
-	return std::all_of(str.begin(), str.end(), isalpha);
-}
-
-template<size_t size> void paginate(std::set<word const> const& from,
-		std::vector<std::array<std::string, size> >& to) {
-	to.clear();
-	to.emplace_back();
-	std::string row;
-	int row_index = 0;
-	for (auto const& str : from) {
-		if (row.size() + str.literal.size() < MAX_COLS) {
-			row += str.literal + " ";
-			continue;
-		}
-		if (row_index == size) {
-			to.emplace_back();
-			row_index = 0;
-		}
-		to.back()[row_index++] = row;
-		row.clear();
-	}
-	if (row.size() > 0) {
-		if (row_index == size) {
-			to.emplace_back();
-			row_index = 0;
-		}
-		to.back()[row_index++] = row;
-	}
-}
-
-word::word(std::string const& w) : literal(w), sorted(w) {
-	std::sort(sorted.begin(), sorted.end());
-}
-
-bool word::operator< (word const& other) const {
-	return literal < other.literal;
-}
-
-bool word::is_one_less_than(std::vector<std::string const>& other) const {
-	std::string o = join(other, "");
-
-	// is length mismatched?
-	if (o.size() - sorted.size() != 1) {
-		return false;
-	}
-
-	// ensure we differ by only one letter
-	std::sort(o.begin(), o.end());
-	int i, j;
-	i = j = 0;
-	while (i < sorted.size() && j < o.size()) {
-		if (sorted[i] == o[j]) {
-			i++;
-			j++;
-			continue;
-		}
-		if (j - i > 1) return false;
-		j++;
-	}
-	return true;
-}
-
-std::set<std::string const> rat_trap_parts::stems_from_str(
-		std::string const& str) {
-	std::set<std::string const> stems;
-	char literal_arr[128];
-
-	if (str.size() >= sizeof(literal_arr)) {
-		throw std::runtime_error("Input length exceeded.");
-	}
-
-	std::string literal = str;
-	if (!lowercase_and_validate(literal) || !spell.spell(str.c_str())) {
-		return stems;
-	}
-
-	bool should_hunspell = false;
-
-	strcpy(literal_arr, literal.c_str());
-	// morph the str to base form first
-	for (int i = NOUN; i <= ADV; i++) {
-		char* buf = morphword(literal_arr, i);
-		// if already base form, be sure to check with hunspell before adding
-		if (buf == nullptr) {
-			if (in_wn(literal_arr, i)) {
-				should_hunspell = true;
-			}
-			continue;
-		}
-		stems.emplace(buf);
-	}
-
-	// then try stemming it
-	if (should_hunspell) {
-		char** stems_arr;
-		int stems_count = spell.stem(&stems_arr, literal_arr);
-		for(int i = 0; i < stems_count; i++) {
-			stems.emplace(stems_arr[i]);
-			i++;
-		}
-		if (stems_count > 0) {
-			spell.free_list(&stems_arr, stems_count);
-		}
-	}
-
-	return stems;
-};
-
 void rat_trap_parts::adjust_screen_dimensions() {
 	int row, col;
 	getmaxyx(stdscr, row, col);
@@ -172,6 +58,40 @@ void rat_trap_parts::help() {
 	clear();
 }
 
+void rat_trap_parts::hint() {
+	char line_buffer[MAX_COLS + 1];
+	std::vector<game_move> moves;
+	rules.hints(state, moves);
+
+	clear();
+	if (moves.empty()) {
+		rmvprintw(0, 0, "No legal moves are left; q<Enter> ends the game.");
+	} else {
+		snprintf(line_buffer, sizeof(line_buffer), "%lu legal moves, best first:",
+				static_cast<unsigned long>(moves.size()));
+		rmvprintw(0, 0, line_buffer);
+	}
+	// one row per move, leaving the last rows for "more" and the prompt
+	int row = 1;
+	for (auto const& m : moves) {
+		if (row == ERROR_ROW - 1 && moves.size() > ERROR_ROW - 1) {
+			snprintf(line_buffer, sizeof(line_buffer), "...and %lu more",
+					static_cast<unsigned long>(moves.size() - (ERROR_ROW - 2)));
+			mvprintw(row, 0, line_buffer);
+			break;
+		}
+		snprintf(line_buffer, sizeof(line_buffer), "%3lu  %s", m.points,
+				move_text(lex, m).c_str());
+		mvprintw(row++, 0, line_buffer);
+	}
+	print_err("Press any key to return to the game.");
+	refresh();
+	noecho();
+	getch();
+	echo();
+	clear();
+}
+
 void rat_trap_parts::setup() {
 	// initialize readme
 	char readme[81*40];
@@ -188,46 +108,43 @@ void rat_trap_parts::setup() {
 		readme_lines.push_back(line);
 	}
 
-	while(current.size() == 0) {
+	// why the last load failed
+	std::string problem;
+	while(state.current.size() == 0) {
 		clear();
 		mvprintw(3, MAX_COLS/2 - sizeof("welcome to")/2, "welcome to");
 		mvprintw(5, MAX_COLS/2 - sizeof("R A T")/2, "R A T");
 		mvprintw(6, MAX_COLS/2 - sizeof("T R A P")/2, "T R A P");
 		mvprintw(7, MAX_COLS/2 - sizeof("P A R T S")/2, "P A R T S");
+		mvprintw(19, 0, problem.c_str());
 		rmvprintw(21, 0, "Enter a 3-letter word to start with.");
-		rmvprintw(22, 0, "'r' or 'random' for random start, 'h' for help.");
+		rmvprintw(22, 0, "'r' or 'random' for random start, 'l' or 'load' to "
+				"resume, 'h' for help.");
 		rmvprintw(PROMPT_ROW, 0, PROMPT_STR);
 		refresh();
 		mvgetnstr(PROMPT_ROW, 2, input_arr, sizeof(input_arr));
 		std::string str(input_arr);
 		if (lowercase_and_validate(str)) {
-			if (str.size() == 3 && spell.spell(str.c_str())) {
-				current.insert(str);
-				std::set<std::string const> stems = stems_from_str(str);
-				used_stems.insert(stems.begin(), stems.end());
+			if (str.size() == START_WORD_LENGTH && rules.start(state, str)) {
 				return;
 			} else if (str == "r" || str == "random") {
-				FILE* f = fopen("valid_words.txt", "r");
-				if (f == nullptr) {
-					throw std::runtime_error("Couldn't read valid words.");
-				}
-				std::vector<std::string const> choices;
-				char data[10240];
-				int read = fread(data, 4, sizeof(data)/4, f);
-				assert(read > 0);
-				fclose(f);
-				if (ferror(f) != 0) {
-					throw std::runtime_error("Couldn't read valid words.");
-				}
-				for (char* start = data; start < data + read*4 - 3; start += 4) {
-					start[3] = '\0';
-					choices.emplace_back(start);
+				std::vector<std::string> choices = read_start_words();
+				std::string choice =
+					choices[std::random_device()()%choices.size()];
+				// the start words list can name words the lexicon lacks
+				if (rules.start(state, choice)) return;
+				problem = "'" + choice + "' isn't a valid start word; "
+					"try again.";
+			} else if (str == "l" || str == "load") {
+				try {
+					saved_game saved(lex);
+					state = saved.state(rules);
+					prior_index = saved.prior_page();
+					current_index = saved.current_page();
+					return;
+				} catch (std::exception& e) {
+					problem = e.what();
 				}
-				std::string choice = choices[std::random_device()()%choices.size()];
-				current.insert(choice);
-				std::set<std::string const> stems = stems_from_str(choice);
-				used_stems.insert(stems.begin(), stems.end());
-				return;
 			} else if (str == "h" || str == "help") {
 				help();
 			}
@@ -235,22 +152,82 @@ void rat_trap_parts::setup() {
 	}
 }
 
+// runs write on the journal, if there still is one.  A failed write, as on a
+// full disk, warns and drops the journal rather than ending the game.
+template<typename F> void rat_trap_parts::to_journal(F write) {
+	if (!journal) return;
+	try {
+		write(*journal);
+	} catch (std::exception& e) {
+		journal.reset();
+		print_err("%s Playing on without one.", e.what());
+	}
+}
+
+// "u[ndo] [n]" or "r[edo] [n]", going n moves back or forward through the
+// game; false if input is neither
+bool rat_trap_parts::time_travel(std::string const& input) {
+	std::istringstream in(input);
+	std::string command;
+	in >> command;
+	bool back = command == "u" || command == "undo";
+	if (!back && command != "r" && command != "redo") return false;
+	unsigned long n;
+	if (!(in >> n)) n = 1;
+	// a word after the command makes it a move after all
+	if (!in.eof()) return false;
+
+	size_t went = back ? history.undo(n) : history.redo(n);
+	if (went == 0) {
+		print_err(back ? "Nothing to undo." : "Nothing to redo.");
+		return true;
+	}
+	state = history.state();
+	paginate(lex, state.prior, prior_strings);
+	paginate(lex, state.current, current_strings);
+	// there may be fewer pages than before
+	prior_index = std::min<size_t>(prior_index, prior_strings.size() - 1);
+	current_index = std::min<size_t>(current_index, current_strings.size() - 1);
+	print_err("%s %lu move%s; %lu to undo, %lu to redo", back ? "Undid" : "Redid",
+			static_cast<unsigned long>(went), went == 1 ? "" : "s",
+			static_cast<unsigned long>(history.moves()),
+			static_cast<unsigned long>(history.undone()));
+	to_journal([&] (journal_writer& j) {
+		if (back) {
+			j.undo(went);
+		} else {
+			j.redo(went);
+		}
+	});
+	return true;
+}
+
 void rat_trap_parts::play() {
 	char line_buffer[MAX_COLS + 1];
 
 	setup();
+	history = game_history(state);
 	clear();
 
-	paginate(prior, prior_strings);
-	paginate(current, current_strings);
-
-	print_err("If confused, press h<Enter>");
+	paginate(lex, state.prior, prior_strings);
+	paginate(lex, state.current, current_strings);
+	// a loaded game's pages
+	prior_index = std::min<size_t>(prior_index, prior_strings.size() - 1);
+	current_index = std::min<size_t>(current_index, current_strings.size() - 1);
+
+	print_err("If confused, press h<Enter>; for hints, !<Enter>; to save, "
+			"s<Enter>");
+	try {
+		journal.reset(new journal_writer(lex, state));
+	} catch (std::exception& e) {
+		print_err("%s Playing on without a journal.", e.what());
+	}
 	while (true) {
 		rmvprintw(SCORE_ROW, 0, SCORE_STR);
 		rmvprintw(PROMPT_ROW, 0, PROMPT_STR);
 		rmvprintw(1, 0, prior_words_row.c_str());
 		rmvprintw(17, 0, current_words_row.c_str());
-		snprintf(line_buffer, MAX_COLS, " %lu", score);
+		snprintf(line_buffer, MAX_COLS, " %lu", state.score);
 		mvprintw(SCORE_ROW, sizeof(SCORE_STR), line_buffer);
 		if (prior_strings.size() > 0) {
 			for (int i = PRIOR_START; i <= PRIOR_END; i++) {
@@ -288,10 +265,8 @@ void rat_trap_parts::play() {
 					static_cast<unsigned long>(current_index + 1));
 			continue;
 		} else if (input == "q") {
-			for (auto const& c : current) {
-				score += c.literal.size() - 3;
-			}
-			snprintf(line_buffer, MAX_COLS, "Your final score is %lu", score);
+			snprintf(line_buffer, MAX_COLS, "Your final score is %lu",
+					rules.final_score(state));
 			mvprintw(SCORE_ROW, 0, line_buffer);
 			print_err("Press any key to continue...");
 			refresh();
@@ -303,86 +278,52 @@ void rat_trap_parts::play() {
 			help();
 			print_blank();
 			continue;
-		}
-
-		char* start = input_arr;
-		char* token;
-
-		// is the first word in our current set?
-		token = strsep(&start, " ");
-		std::string chosen(token);
-		if (current.count(chosen) == 0) {
-			print_err("'%s' is not a current word.", chosen.c_str());
+		} else if (input == "!" || input == "hint") {
+			hint();
+			print_blank();
 			continue;
-		}
-
-		// make sure the candidates are are lowercase alpha and at least 3 chars
-		// long
-		std::vector<std::string const> candidates;
-		bool entry_invalid = false;
-		if (start == nullptr) {
-			print_err("Need at least one word...");
+		} else if (time_travel(input)) {
 			continue;
-		}
-
-		while(start != nullptr) {
-			std::string str(strsep(&start, " "));
-			if (!lowercase_and_validate(str) || str.size() < 3) {
-				print_err("'%s' is not alpha/too short", str.c_str());
-				entry_invalid = true;
-				break;
+		} else if (input == "s" || input == "save") {
+			try {
+				saved_game::write(lex, stems, state, prior_index, current_index);
+				print_err("Saved to " SAVE_FILE "; 'l' at the start resumes.");
+			} catch (std::exception& e) {
+				print_err("%s", e.what());
+			}
+			continue;
+		} else if (input == "!!" || input == "advise") {
+			print_err("Thinking...");
+			refresh();
+			mcts_options options;
+			options.time_limit = ADVISOR_SECONDS;
+			mcts_advice advice = rules.advise(state, options);
+			if (!advice.found) {
+				print_err("No legal moves are left; q<Enter> ends the game.");
+			} else {
+				print_err("Try '%s' (%.0f on average, %lu at best)",
+						move_text(lex, advice.best).c_str(), advice.mean_score,
+						advice.best_score);
 			}
-			candidates.push_back(str);
-		}
-		if (entry_invalid) continue;
-
-		if (!word(chosen).is_one_less_than(candidates)) {
-			print_err("Not a valid anagram + extra letter");
 			continue;
 		}
 
-		int score_this_round = 0;
-		std::set<std::string const> stems_this_round;
-		for (auto const& candidate : candidates) {
-			std::set<std::string const> stems = stems_from_str(candidate);
-			// is this even a real word?
-			if (stems.size() == 0) {
-				print_err("'%s' isn't a valid word", candidate.c_str());
-				entry_invalid = true;
-				break;
-			}
-			// is at least one stem of this word used?
-			bool was_scored = false;
-			for (auto const& stem : stems) {
-				if (used_stems.count(stem) == 0 && stems_this_round.count(stem) == 0) {
-					stems_this_round.insert(stem);
-					if (!was_scored) {
-						score_this_round += candidate.size() - 3;
-						was_scored = true;
-					}
-				} else {
-					print_err("'%s' already used previously", candidate.c_str());
-					entry_invalid = true;
-					break;
-				}
-			}
+		game_move made;
+		move_result result = rules.apply_move(state, input_arr, &made);
+		if (result.status != move_status::ok) {
+			print_err(move_message(result.status), result.subject);
+			continue;
 		}
-		if (entry_invalid) continue;
-		score += score_this_round;
-		used_stems.insert(stems_this_round.begin(), stems_this_round.end());
-		current.erase(chosen);
-		prior.insert(chosen);
-		current.insert(candidates.begin(), candidates.end());
-		paginate(prior, prior_strings);
-		paginate(current, current_strings);
+		history.push(state);
+		to_journal([&] (journal_writer& j) { j.move(made); });
+		paginate(lex, state.prior, prior_strings);
+		paginate(lex, state.current, current_strings);
 	}
 };
 
-rat_trap_parts::rat_trap_parts() : spell(HUNSPELL_AFF, HUNSPELL_DIC),
-		prior_index(0), current_index(0), score(0) {
-	if (wninit() != 0) {
-		throw std::runtime_error("Failed to initialize WordNet.");
-	}
+rat_trap_parts::rat_trap_parts() : lex(LEXICON_SNAPSHOT),
+		stems(lex, STEMS_SNAPSHOT), rules(lex, stems), state(rules.new_game()),
+		history(state), prior_index(0), current_index(0) {
 	if (initscr() == nullptr) {
 		throw std::runtime_error("Failed to initialize ncurses.");
 	}
@@ -3,44 +3,44 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-#include <set>
+#include <array>
+#include <memory>
 #include <string>
 #include <vector>
 
-#include <hunspell/hunspell.hxx> // for stem
-
+#include "engine.hpp"
+#include "game_history.hpp"
+#include "journal.hpp"
+#include "lexicon.hpp"
 #include "ncurses_wrappers.hpp"
-
-struct word {
-	std::string literal;
-	std::string sorted;
-
-	word(std::string const& w);
-	bool operator< (word const& other) const;
-	bool is_one_less_than(std::vector<std::string const>& other) const;
-};
+#include "stem_source.hpp"
 
 class rat_trap_parts {
-	Hunspell spell;
+	lexicon lex;
+	stem_source stems;
+	engine rules;
+	game_state state;
+	game_history history;
+	// every move made, for recovering and auditing games; null once writing
+	// it has failed
+	std::unique_ptr<journal_writer> journal;
 
-	char input_arr[128];
+	char input_arr[MAX_INPUT_LENGTH];
 
-	std::set<const word> current;
-	std::set<const word> prior;
 	std::vector<std::array<std::string, PRIOR_END - PRIOR_START + 1> >
 		prior_strings;
 	std::vector<std::array<std::string, CURRENT_END - CURRENT_START + 1> >
 		current_strings;
 	unsigned int prior_index;
 	unsigned int current_index;
-	std::set<const std::string> used_stems;
-	unsigned long score;
 
 	std::vector<std::string const> readme_lines;
 
-	std::set<std::string const> stems_from_str(std::string const& str);
 	void adjust_screen_dimensions();
 	void help();
+	void hint();
+	bool time_travel(std::string const& input);
+	template<typename F> void to_journal(F write);
 	void setup();
 	void play();
 
@@ -48,4 +48,6 @@ class rat_trap_parts {
 	rat_trap_parts();
 	~rat_trap_parts();
 	void go();
+
+	stem_cache& stem_results() { return stems.cache(); }
 };
@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Replays the last game in a journal through the engine, checking every move
+// against the rules, and prints where the game ended up.  Replaying more than
+// once times the replay.  Given a save file, it also writes the game there,
+// so that 'l' at the game's start resumes it after a crash.
+// usage: replay [journal] [times] [save]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+#include "engine.hpp"
+#include "journal.hpp"
+#include "lexicon.hpp"
+#include "saved_game.hpp"
+#include "stem_source.hpp"
+
+typedef std::chrono::steady_clock replay_clock;
+
+int main(int argc, char** argv) try {
+	if (argc > 4) {
+		fprintf(stderr, "usage: %s [journal] [times] [save]\n", argv[0]);
+		return 2;
+	}
+	char const* path = argc > 1 ? argv[1] : JOURNAL_FILE;
+	unsigned times = argc > 2 ? atoi(argv[2]) : 1;
+	if (times == 0) times = 1;
+
+	lexicon lex(LEXICON_SNAPSHOT);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	journal_reader journal(lex, path);
+
+	replay_result r;
+	replay_clock::time_point start = replay_clock::now();
+	for (unsigned i = 0; i < times; i++) {
+		r = journal.replay(rules);
+	}
+	double elapsed = std::chrono::duration<double>(replay_clock::now() -
+			start).count();
+
+	printf("%s: %lu games; the last has %llu moves, %llu undos, "
+			"%llu redos%s\n", path, static_cast<unsigned long>(journal.games()),
+			static_cast<unsigned long long>(r.moves),
+			static_cast<unsigned long long>(r.undos),
+			static_cast<unsigned long long>(r.redos),
+			r.truncated ? "; the last record was cut short" : "");
+	printf("score %lu, final score %lu, %lu current and %lu prior words\n",
+			r.state.score, rules.final_score(r.state),
+			static_cast<unsigned long>(r.state.current.size()),
+			static_cast<unsigned long>(r.state.prior.size()));
+	if (argc > 3) {
+		saved_game::write(lex, stems, r.state, 0, 0, argv[3]);
+		printf("saved to %s\n", argv[3]);
+	}
+	if (elapsed > 0 && r.moves > 0) {
+		fprintf(stderr, "%.0f moves/s over %u replays\n",
+				r.moves * times / elapsed, times);
+	}
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
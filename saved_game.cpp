@@ -0,0 +1,108 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "saved_game.hpp"
+
+static size_t padded(size_t bytes) {
+	return (bytes + 7) & ~size_t(7);
+}
+
+static size_t bitset_words(size_t bits) {
+	return (bits + 63) / 64;
+}
+
+// true if a bitset of bits IDs, in bitset_words(bits) words, has nothing set
+// past its last ID
+static bool fits(uint64_t const* words, size_t bits) {
+	if (bits % 64 == 0) return true;
+	return (words[bits / 64] >> (bits % 64)) == 0;
+}
+
+saved_game::saved_game(lexicon const& lex, char const* path) : file(path) {
+	if (file.size() < sizeof(save_header)) {
+		throw std::runtime_error("Saved game is truncated.");
+	}
+	header = reinterpret_cast<save_header const*>(file.data());
+	if (memcmp(header->magic, SAVE_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a saved game.");
+	}
+	if (header->version != SAVE_VERSION) {
+		throw std::runtime_error("Saved game version mismatch.");
+	}
+	if (header->word_count != lex.size() ||
+			header->prior_words != bitset_words(header->word_count) ||
+			header->stem_words != bitset_words(header->stem_count)) {
+		throw std::runtime_error("Saved game doesn't match the lexicon.");
+	}
+	size_t current_size = padded(header->current_count * sizeof(word_id));
+	if (file.size() != sizeof(save_header) + current_size +
+			(header->prior_words + header->stem_words) * sizeof(uint64_t)) {
+		throw std::runtime_error("Saved game is truncated.");
+	}
+	current = reinterpret_cast<word_id const*>(file.data() +
+			sizeof(save_header));
+	prior = reinterpret_cast<uint64_t const*>(file.data() +
+			sizeof(save_header) + current_size);
+	used_stems = prior + header->prior_words;
+	for (uint32_t i = 0; i < header->current_count; i++) {
+		if (current[i] >= header->word_count) {
+			throw std::runtime_error("Saved game is corrupt.");
+		}
+	}
+	// IDs past the lexicon's or stem table's end would be looked up later
+	if (!fits(prior, header->word_count) ||
+			!fits(used_stems, header->stem_count)) {
+		throw std::runtime_error("Saved game is corrupt.");
+	}
+}
+
+game_state saved_game::state(engine& rules) const {
+	game_state state;
+	state.current.insert(current, current + header->current_count);
+	state.prior = persistent_bitset(prior, header->prior_words);
+	state.score = header->score;
+	stem_source& stems = rules.stem_lookup();
+	if ((header->flags & SAVE_BAKED_STEMS) != 0 && stems.is_baked() &&
+			header->stem_count == stems.stem_count()) {
+		state.used_stems = persistent_bitset(used_stems, header->stem_words);
+		return state;
+	}
+	rules.restore_stems(state);
+	return state;
+}
+
+void saved_game::write(lexicon const& lex, stem_source const& stems,
+		game_state const& state, unsigned prior_page, unsigned current_page,
+		char const* path) {
+	save_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, SAVE_MAGIC, sizeof(h.magic));
+	h.version = SAVE_VERSION;
+	h.word_count = lex.size();
+	h.stem_count = stems.stem_count();
+	h.flags = stems.is_baked() ? SAVE_BAKED_STEMS : 0;
+	h.score = state.score;
+	h.prior_page = prior_page;
+	h.current_page = current_page;
+	h.current_count = state.current.size();
+	h.prior_words = bitset_words(h.word_count);
+	h.stem_words = bitset_words(h.stem_count);
+
+	std::vector<uint64_t> bits(h.prior_words + h.stem_words);
+	state.prior.to_words(bits.data(), h.prior_words);
+	state.used_stems.to_words(bits.data() + h.prior_words, h.stem_words);
+
+	std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+	out.append(reinterpret_cast<char const*>(state.current.words().data()),
+			h.current_count * sizeof(word_id));
+	out.resize(padded(out.size()), '\0');
+	out.append(reinterpret_cast<char const*>(bits.data()),
+			bits.size() * sizeof(uint64_t));
+	write_file_atomic(path, out.data(), out.size());
+}
@@ -0,0 +1,63 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+
+#include "engine.hpp"
+#include "lexicon.hpp"
+#include "mapped_file.hpp"
+#include "stem_source.hpp"
+
+#define SAVE_FILE "rat_trap_parts.sav"
+#define SAVE_MAGIC "RTP-SAV"
+#define SAVE_VERSION 1
+
+// set in flags when used_stems holds baked stem IDs.  Live stem IDs are
+// handed out in the order stems are first seen, so they mean nothing to
+// another process; those games get their stems back from their words.
+#define SAVE_BAKED_STEMS 1
+
+// on-disk layout: header, current_count current word IDs (padded to 8 bytes),
+// the prior words as a bitset of prior_words 64-bit words over word IDs, then
+// the used stems as a bitset of stem_words 64-bit words over stem IDs
+struct save_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+	uint32_t stem_count;
+	uint32_t flags;
+	uint64_t score;
+	// the pages of prior and current words on screen
+	uint32_t prior_page;
+	uint32_t current_page;
+	uint32_t current_count;
+	uint32_t prior_words;
+	uint32_t stem_words;
+	uint32_t reserved;
+};
+
+// a game saved by write(), mapped read-only.  The bitsets are the persistent
+// ones' leaves laid end to end, so restoring copies memory rather than
+// inserting word by word, however long the game.
+class saved_game {
+	mapped_file file;
+	save_header const* header;
+	word_id const* current;
+	uint64_t const* prior;
+	uint64_t const* used_stems;
+
+	public:
+	// throws unless path holds a game saved against lex
+	saved_game(lexicon const& lex, char const* path = SAVE_FILE);
+
+	unsigned prior_page() const { return header->prior_page; }
+	unsigned current_page() const { return header->current_page; }
+	game_state state(engine& rules) const;
+
+	// saves atomically, so a crash mid-save keeps the last save
+	static void write(lexicon const& lex, stem_source const& stems,
+			game_state const& state, unsigned prior_page, unsigned current_page,
+			char const* path = SAVE_FILE);
+};
@@ -0,0 +1,61 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Hosts games over a Unix socket, one per connection, sharing one lexicon and
+// stem table among them all.  See game_server.hpp for the protocol.
+// usage: server [socket]
+
+#include <csignal>
+#include <cstdio>
+#include <exception>
+
+#include <sys/resource.h>
+
+#include "engine.hpp"
+#include "game_server.hpp"
+#include "lexicon.hpp"
+#include "stem_source.hpp"
+
+static volatile sig_atomic_t stop = 0;
+
+static void on_signal(int) {
+	stop = 1;
+}
+
+int main(int argc, char** argv) try {
+	if (argc > 2) {
+		fprintf(stderr, "usage: %s [socket]\n", argv[0]);
+		return 2;
+	}
+	char const* path = argc > 1 ? argv[1] : SERVER_SOCKET;
+
+	// a descriptor per session, so as many as we're allowed
+	rlimit files;
+	if (getrlimit(RLIMIT_NOFILE, &files) == 0) {
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+	}
+	// without sigaction's SA_RESTART, epoll_wait returns on a signal and the
+	// loop sees stop
+	struct sigaction action;
+	action.sa_handler = on_signal;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = 0;
+	sigaction(SIGINT, &action, nullptr);
+	sigaction(SIGTERM, &action, nullptr);
+
+	lexicon lex(LEXICON_SNAPSHOT);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	engine rules(lex, stems);
+	game_server server(rules, path);
+	fprintf(stderr, "%s: serving %lu words\n", path,
+			static_cast<unsigned long>(lex.size()));
+	server.run(stop);
+	fprintf(stderr, "%s: stopped with %lu sessions open\n", path,
+			static_cast<unsigned long>(server.session_count()));
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
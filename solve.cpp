@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Searches for the best score reachable from a start word and prints the
+// moves that reach it.
+// usage: solve <start word|random> [max nodes] [seconds] [threads] [table MB]
+//              [max moves]
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "anagram_index.hpp"
+#include "engine.hpp"
+#include "lexicon.hpp"
+#include "solver.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+
+int main(int argc, char** argv) try {
+	if (argc < 2 || argc > 7) {
+		fprintf(stderr, "usage: %s <start word|random> [max nodes] [seconds] "
+				"[threads] [table MB] [max moves]\n", argv[0]);
+		return 2;
+	}
+	std::string start = argv[1];
+	if (start == "r" || start == "random") {
+		std::vector<std::string> choices = read_start_words();
+		start = choices[std::random_device()()%choices.size()];
+	}
+	solver_options options;
+	if (argc > 2) options.max_nodes = strtoull(argv[2], nullptr, 10);
+	if (argc > 3) options.time_limit = atof(argv[3]);
+	if (argc > 4) options.threads = atoi(argv[4]);
+	if (argc > 5) options.table_bytes = strtoull(argv[5], nullptr, 10) << 20;
+	if (argc > 6) options.max_moves = atoi(argv[6]);
+
+	lexicon lex(LEXICON_SNAPSHOT);
+	stem_source stems(lex, STEMS_SNAPSHOT);
+	anagram_index index(lex);
+	successor_graph graph(lex, SUCCESSORS_SNAPSHOT);
+	// the bound table is optional; without it the search just doesn't prune
+	std::unique_ptr<bound_table> bounds;
+	if (access(BOUNDS_SNAPSHOT, R_OK) == 0) {
+		bounds.reset(new bound_table(lex, BOUNDS_SNAPSHOT));
+	}
+	solver s(lex, index, graph, stems, bounds.get());
+	solution best = s.solve(start, options);
+
+	printf("%s: %lu (%s, %llu positions)\n", best.start.c_str(), best.score,
+			best.complete ? "optimal" : "best found",
+			static_cast<unsigned long long>(best.nodes));
+	for (auto const& m : best.moves) {
+		printf("%s\n", move_text(lex, m).c_str());
+	}
+	return 0;
+} catch(std::exception &e) {
+	fprintf(stderr, "%s\n", e.what());
+	return 1;
+};
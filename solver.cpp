@@ -0,0 +1,346 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "engine.hpp"
+#include "solver.hpp"
+
+typedef std::chrono::steady_clock solver_clock;
+
+// how many positions a worker searches between reading the clock and
+// publishing its node count
+#define SOLVER_NODE_BATCH 64
+
+namespace {
+
+// an untried branch: the position it starts from and the moves that led there
+struct task {
+	position p;
+	std::vector<game_move> path;
+};
+
+// a worker's untried branches.  The owner pushes and pops at the back, so it
+// carries on depth first; thieves take from the front, where the oldest
+// branches are.
+struct task_deque {
+	std::mutex lock;
+	std::deque<task> tasks;
+	// tasks.size(), readable without the lock
+	std::atomic<size_t> size;
+
+	task_deque() : size(0) {}
+};
+
+// what the workers share
+struct search {
+	lexicon const& lex;
+	anagram_index const& index;
+	successor_graph const& graph;
+	stem_source& stems;
+	bound_table const* bounds;
+	solver_options const& options;
+	solver_clock::time_point deadline;
+	std::vector<std::unique_ptr<task_deque> > deques;
+	std::unique_ptr<transposition_table> table;
+
+	// the best score seen, raised without the lock; best_line catches up when
+	// the worker that found it backs out of the line
+	std::atomic<unsigned long> best_score;
+	std::mutex best_lock;
+	unsigned long best_line_score;
+	std::vector<game_move> best_line;
+
+	std::atomic<uint64_t> nodes;
+	std::atomic<bool> aborted;
+	// tasks pushed and not yet finished; the search is over when none are left
+	std::atomic<uint64_t> outstanding;
+	// workers without a task.  Busy workers hand out branches while this
+	// exceeds what they already have queued.
+	std::atomic<size_t> idle;
+
+	search(lexicon const& lex, anagram_index const& index,
+			successor_graph const& graph, stem_source& stems,
+			bound_table const* bounds, solver_options const& options,
+			size_t threads)
+		: lex(lex), index(index), graph(graph), stems(stems), bounds(bounds),
+		options(options), best_score(0), best_line_score(0), nodes(0),
+		aborted(false), outstanding(0), idle(threads) {
+		deadline = solver_clock::now() + std::chrono::duration_cast<
+			solver_clock::duration>(std::chrono::duration<double>(
+						options.time_limit));
+		for (size_t i = 0; i < threads; i++) {
+			deques.emplace_back(new task_deque);
+		}
+		if (options.table_bytes != 0) {
+			table.reset(new transposition_table(options.table_bytes,
+						options.table_policy));
+		}
+	}
+
+	void push(size_t owner, task&& t) {
+		outstanding++;
+		task_deque& d = *deques[owner];
+		std::lock_guard<std::mutex> hold(d.lock);
+		d.tasks.push_back(std::move(t));
+		d.size = d.tasks.size();
+	}
+
+	// the owner's newest task, else the oldest task of another worker
+	bool take(size_t owner, task& t) {
+		for (size_t i = 0; i < deques.size(); i++) {
+			task_deque& d = *deques[(owner + i) % deques.size()];
+			if (d.size == 0) continue;
+			std::lock_guard<std::mutex> hold(d.lock);
+			if (d.tasks.empty()) continue;
+			if (i == 0) {
+				t = std::move(d.tasks.back());
+				d.tasks.pop_back();
+			} else {
+				t = std::move(d.tasks.front());
+				d.tasks.pop_front();
+			}
+			d.size = d.tasks.size();
+			return true;
+		}
+		return false;
+	}
+
+	// raises best_score to value; true if this call raised it
+	bool improve(unsigned long value) {
+		unsigned long seen = best_score;
+		while (value > seen) {
+			if (best_score.compare_exchange_weak(seen, value)) return true;
+		}
+		return false;
+	}
+
+	void record(unsigned long score, std::vector<game_move> const& path) {
+		std::lock_guard<std::mutex> hold(best_lock);
+		if (score > best_line_score) {
+			best_line_score = score;
+			best_line = path;
+		}
+	}
+};
+
+struct worker {
+	search& shared;
+	size_t self;
+	move_generator gen;
+	std::vector<game_move> path;
+	// a best line found here is a prefix of path, not yet copied out: copying
+	// it at every improvement would cost O(depth) per position on a deep line
+	bool best_pending;
+	unsigned long pending_score;
+	size_t best_depth;
+	// positions searched and not yet added to shared.nodes
+	uint64_t nodes;
+	// ceiling()'s scratch space
+	std::vector<unsigned long> most, next_most;
+	// words made by the moves searched here, and the longest line
+	std::vector<bool> seen;
+	size_t deepest;
+
+	worker(search& shared, size_t self)
+		: shared(shared), self(self),
+		gen(shared.lex, shared.index, shared.graph, shared.stems),
+		best_pending(false), pending_score(0), best_depth(0), nodes(0),
+		seen(shared.lex.size(), false), deepest(0) {}
+
+	bool out_of_budget() {
+		if (shared.aborted) return true;
+		uint64_t max = shared.options.max_nodes;
+		if (max != 0 && shared.nodes + nodes >= max) return true;
+		if (nodes < SOLVER_NODE_BATCH) return false;
+		shared.nodes += nodes;
+		nodes = 0;
+		// reading the clock every node would dominate small searches
+		return shared.options.time_limit != 0 &&
+			solver_clock::now() >= shared.deadline;
+	}
+
+	// copies out the best line once the search is back at its end
+	void settle() {
+		if (best_pending && path.size() == best_depth) {
+			shared.record(pending_score, path);
+			best_pending = false;
+		}
+	}
+
+	// the most the current words can add to the final score in moves moves,
+	// shared out among them as best suits
+	unsigned long ceiling(position const& p, unsigned moves) {
+		bound_table const& bounds = *shared.bounds;
+		most.assign(moves + 1, 0);
+		for (word_id w : p.current) {
+			next_most.assign(moves + 1, 0);
+			for (unsigned total = 0; total <= moves; total++) {
+				for (unsigned mine = 0; mine <= total; mine++) {
+					next_most[total] = std::max(next_most[total],
+							most[total - mine] + bounds.bound(w, mine));
+				}
+			}
+			most.swap(next_most);
+		}
+		return most[moves];
+	}
+
+	// hands the branch that m leads to over to the deque, if idle workers
+	// could use it
+	bool share(position const& p, game_move const& m) {
+		if (shared.idle <= shared.deques[self]->size) return false;
+		task t;
+		t.p = p;
+		t.p.apply(shared.lex, m);
+		t.path = path;
+		t.path.push_back(m);
+		shared.push(self, std::move(t));
+		return true;
+	}
+
+	void run(position& p) {
+		nodes++;
+		// a position's other words were all made earlier on its line
+		if (!path.empty()) {
+			for (word_id w : path.back().words) {
+				seen[w] = true;
+			}
+		}
+		deepest = std::max(deepest, path.size());
+		unsigned long value = p.value();
+		if (value > shared.best_score && shared.improve(value)) {
+			best_pending = true;
+			pending_score = value;
+			best_depth = path.size();
+		}
+		if (out_of_budget()) {
+			shared.aborted = true;
+			return;
+		}
+		// what follows depends only on current and used, so another move order
+		// that got here with as many points has it covered
+		if (shared.table &&
+				!shared.table->improves(p.hash, p.score, path.size())) {
+			return;
+		}
+		unsigned max_moves = shared.options.max_moves;
+		if (max_moves != 0) {
+			unsigned left = max_moves - path.size();
+			if (left == 0) return;
+			if (shared.bounds && left <= shared.bounds->layers() &&
+					p.score + ceiling(p, left) <= shared.best_score) {
+				return;
+			}
+		}
+
+		// one current word's moves at a time, so a deep line of play holds only
+		// a word's worth of moves per level
+		std::vector<word_id> current = p.current;
+		std::vector<game_move> moves;
+		for (word_id chosen : current) {
+			moves.clear();
+			gen.moves_from(chosen, p.used, moves);
+			// high scoring moves first, so good answers turn up early
+			std::stable_sort(moves.begin(), moves.end(),
+					[] (game_move const& a, game_move const& b) {
+						return a.points > b.points;
+					});
+			for (auto const& m : moves) {
+				if (share(p, m)) continue;
+				p.apply(shared.lex, m);
+				path.push_back(m);
+				run(p);
+				settle();
+				path.pop_back();
+				p.undo(shared.lex, m);
+				if (shared.aborted) return;
+			}
+		}
+	}
+
+	void work() {
+		task t;
+		for (;;) {
+			while (!shared.take(self, t)) {
+				if (shared.outstanding == 0 || shared.aborted) {
+					shared.nodes += nodes;
+					nodes = 0;
+					return;
+				}
+				std::this_thread::yield();
+			}
+			shared.idle--;
+			path = std::move(t.path);
+			run(t.p);
+			settle();
+			path.clear();
+			shared.idle++;
+			shared.outstanding--;
+		}
+	}
+};
+
+}
+
+solution solver::solve(std::string const& start,
+		solver_options const& options) {
+	std::string literal = start;
+	word_id id = no_word;
+	if (lowercase_and_validate(literal) &&
+			literal.size() == START_WORD_LENGTH) {
+		id = lex.find(literal);
+	}
+	stem_range start_stems = stems.stems(id);
+	if (start_stems.empty()) {
+		throw std::runtime_error("'" + start + "' is not a valid start word.");
+	}
+
+	size_t threads = options.threads;
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+	if (!stems.is_baked()) threads = 1;
+
+	task root;
+	root.p = position(id, start_stems, stems.stem_count());
+
+	search s(lex, index, graph, stems, bounds, options, threads);
+	s.push(0, std::move(root));
+	std::vector<std::unique_ptr<worker> > workers;
+	for (size_t i = 0; i < threads; i++) {
+		workers.emplace_back(new worker(s, i));
+	}
+	std::vector<std::thread> pool;
+	for (size_t i = 1; i < threads; i++) {
+		pool.emplace_back(&worker::work, workers[i].get());
+	}
+	workers[0]->work();
+	for (auto& t : pool) {
+		t.join();
+	}
+
+	solution best;
+	best.start = literal;
+	best.score = s.best_score;
+	best.moves = s.best_line;
+	best.nodes = s.nodes;
+	best.complete = !s.aborted;
+	best.depth = 0;
+	std::vector<bool> seen(lex.size(), false);
+	seen[id] = true;
+	for (auto const& w : workers) {
+		best.depth = std::max(best.depth, w->deepest);
+		for (word_id i = 0; i < lex.size(); i++) {
+			if (w->seen[i]) seen[i] = true;
+		}
+	}
+	best.reachable = std::count(seen.begin(), seen.end(), true);
+	return best;
+}
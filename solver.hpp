@@ -0,0 +1,80 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "bound_table.hpp"
+#include "lexicon.hpp"
+#include "move_generator.hpp"
+#include "stem_source.hpp"
+#include "successor_graph.hpp"
+#include "transposition_table.hpp"
+
+#define SOLVER_TABLE_BYTES (size_t(64) << 20)
+
+struct solver_options {
+	// stop after this many positions; 0 for no limit
+	uint64_t max_nodes;
+	// stop after this many seconds; 0 for no limit
+	double time_limit;
+	// worker threads; 0 for one per core.  The live stemmer isn't
+	// thread-safe, so without baked stems the search runs on one thread.
+	unsigned threads;
+	// memory for the transposition table, which skips states already reached
+	// with as good a score by another move order; 0 for none
+	size_t table_bytes;
+	replacement table_policy;
+	// only look at games of this many moves or fewer; 0 for no limit.  With a
+	// limit, a bound table prunes lines that can't beat the best found.
+	unsigned max_moves;
+
+	solver_options() : max_nodes(0), time_limit(0), threads(0),
+		table_bytes(SOLVER_TABLE_BYTES),
+		table_policy(replacement::depth_preferred), max_moves(0) {}
+};
+
+struct solution {
+	std::string start;
+	// final score, current words counted double
+	unsigned long score;
+	std::vector<game_move> moves;
+	uint64_t nodes;
+	// true if the search ran to the end, so score is the optimum within
+	// options.max_moves
+	bool complete;
+	// distinct words in the positions searched, the start included.  Only
+	// what the search touched: pruned and unfinished lines aren't counted,
+	// so it's a lower bound on the words the start can lead to.
+	size_t reachable;
+	// moves in the longest line searched
+	size_t depth;
+};
+
+// depth-first search over move sequences from a start word, under the game's
+// rules, for the best final score.  Subtrees are shared out over a
+// work-stealing pool: each worker searches depth first and, while others are
+// idle, pushes untried branches onto its own deque; idle workers steal the
+// oldest, and so shallowest and largest, branch they can find.
+class solver {
+	lexicon const& lex;
+	anagram_index const& index;
+	successor_graph const& graph;
+	stem_source& stems;
+	bound_table const* bounds;
+
+	public:
+	// bounds may be null, for no pruning
+	solver(lexicon const& lex, anagram_index const& index,
+			successor_graph const& graph, stem_source& stems,
+			bound_table const* bounds = nullptr)
+		: lex(lex), index(index), graph(graph), stems(stems), bounds(bounds) {}
+
+	// throws if start isn't a valid start word
+	solution solve(std::string const& start,
+			solver_options const& options = solver_options());
+};
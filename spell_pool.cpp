@@ -0,0 +1,90 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "spell_pool.hpp"
+
+spell_pool::spell_pool(char const* aff, char const* dic) : aff(aff), dic(dic) {
+}
+
+std::unique_ptr<Hunspell> spell_pool::borrow() {
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		if (!idle.empty()) {
+			std::unique_ptr<Hunspell> spell = std::move(idle.back());
+			idle.pop_back();
+			return spell;
+		}
+	}
+	std::lock_guard<std::mutex> hold(loading);
+	return std::unique_ptr<Hunspell>(new Hunspell(aff.c_str(), dic.c_str()));
+}
+
+void spell_pool::give_back(std::unique_ptr<Hunspell> spell) {
+	std::lock_guard<std::mutex> hold(lock);
+	idle.push_back(std::move(spell));
+}
+
+void spell_pool::reserve(unsigned n) {
+	while (free_handles() < n) {
+		std::unique_ptr<Hunspell> spell;
+		{
+			std::lock_guard<std::mutex> hold(loading);
+			spell.reset(new Hunspell(aff.c_str(), dic.c_str()));
+		}
+		give_back(std::move(spell));
+	}
+}
+
+size_t spell_pool::free_handles() {
+	std::lock_guard<std::mutex> hold(lock);
+	return idle.size();
+}
+
+std::vector<std::string> spell_pool::checker::stems(char const* word) {
+	std::vector<std::string> stems;
+	char** list;
+	int count = spell->stem(&list, word);
+	for (int i = 0; i < count; i++) {
+		stems.emplace_back(list[i]);
+	}
+	if (count > 0) {
+		spell->free_list(&list, count);
+	}
+	return stems;
+}
+
+std::vector<char> spell_pool::check(std::vector<std::string> const& words,
+		unsigned threads) {
+	std::vector<char> right(words.size());
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	// no more threads than batches
+	threads = std::max(1u, std::min<unsigned>(threads,
+				(words.size() + SPELL_BATCH - 1) / SPELL_BATCH));
+
+	std::atomic<size_t> next(0);
+	auto work = [&] () {
+		checker spell(*this);
+		for (;;) {
+			size_t begin = next.fetch_add(SPELL_BATCH);
+			if (begin >= words.size()) return;
+			size_t end = std::min(begin + SPELL_BATCH, words.size());
+			for (size_t i = begin; i < end; i++) {
+				right[i] = spell.check(words[i].c_str());
+			}
+		}
+	};
+	std::vector<std::thread> pool;
+	for (unsigned i = 1; i < threads; i++) {
+		pool.emplace_back(work);
+	}
+	work();
+	for (auto& t : pool) {
+		t.join();
+	}
+	return right;
+}
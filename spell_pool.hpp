@@ -0,0 +1,65 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <hunspell/hunspell.hxx>
+
+#define HUNSPELL_AFF "en_US.aff"
+#define HUNSPELL_DIC "en_US.dic"
+
+// words a checking thread takes at a time
+#define SPELL_BATCH 1024
+
+// Hunspell handles for any number of threads.  One Hunspell may only be used
+// by one thread at a time, and each takes a good fraction of a second to
+// load, so threads borrow handles from the pool and give them back for the
+// next, and a handle is only loaded when none is free.
+class spell_pool {
+	std::string aff;
+	std::string dic;
+	std::mutex lock;
+	std::vector<std::unique_ptr<Hunspell> > idle;
+	// held while loading; Hunspell sets up some tables shared by every
+	// handle on first use, unguarded
+	std::mutex loading;
+
+	std::unique_ptr<Hunspell> borrow();
+	void give_back(std::unique_ptr<Hunspell> spell);
+
+	public:
+	// a handle of the calling thread's own until destroyed
+	class checker {
+		spell_pool& pool;
+		std::unique_ptr<Hunspell> spell;
+
+		public:
+		explicit checker(spell_pool& pool)
+			: pool(pool), spell(pool.borrow()) {}
+		~checker() { pool.give_back(std::move(spell)); }
+		checker(checker const&) = delete;
+		checker& operator= (checker const&) = delete;
+
+		bool check(char const* word) { return spell->spell(word) != 0; }
+		// Hunspell's stems for word, its list freed
+		std::vector<std::string> stems(char const* word);
+	};
+
+	spell_pool(char const* aff = HUNSPELL_AFF, char const* dic = HUNSPELL_DIC);
+
+	// loads handles until n are free, so threads starting together don't
+	// queue to load their own
+	void reserve(unsigned n);
+	size_t free_handles();
+
+	// whether each of words is spelled right, checked on threads threads (0
+	// for one per core) each with a handle of its own.  chars rather than a
+	// vector<bool>, whose bits threads can't set independently.
+	std::vector<char> check(std::vector<std::string> const& words,
+			unsigned threads = 0);
+};
@@ -0,0 +1,110 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+
+#include "split_enumerator.hpp"
+
+bool split_enumerator::search(std::string const& remaining,
+		int32_t prev_signature, word_id prev_id, context& ctx) {
+	if (remaining.empty()) {
+		ctx.found->ids.insert(ctx.found->ids.end(), ctx.path.begin(),
+				ctx.path.end());
+		ctx.found->ends.push_back(ctx.found->ids.size());
+		return (*ctx.visit)(ctx.path);
+	}
+	// runs of equal letters; the next part must take at least one of the
+	// first run, the smallest letter left
+	std::vector<size_t> runs;
+	for (size_t i = 0; i < remaining.size(); i++) {
+		if (i == 0 || remaining[i] != remaining[i - 1]) runs.push_back(i);
+	}
+	runs.push_back(remaining.size());
+	std::string rest;
+	return walk(remaining, runs, 0, index.root(), 0, rest, prev_signature,
+			prev_id, ctx);
+}
+
+bool split_enumerator::walk(std::string const& remaining,
+		std::vector<size_t> const& runs, size_t run, uint32_t node,
+		size_t part_size, std::string& rest, int32_t prev_signature,
+		word_id prev_id, context& ctx) {
+	if (run + 1 == runs.size()) {
+		int32_t signature = index.signature_at(node);
+		if (signature < 0 || signature < prev_signature ||
+				part_size < MIN_WORD_LENGTH ||
+				(!rest.empty() && rest.size() < MIN_WORD_LENGTH)) {
+			return true;
+		}
+		for (word_id id : index.words_of(signature)) {
+			if (signature == prev_signature && id <= prev_id) continue;
+			ctx.path.push_back(id);
+			bool go_on = search(rest, signature, id, ctx);
+			ctx.path.pop_back();
+			if (!go_on) return false;
+		}
+		return true;
+	}
+
+	char letter = remaining[runs[run]];
+	size_t count = runs[run + 1] - runs[run];
+	size_t rest_size = rest.size();
+	// take k of this run into the part and leave the others
+	for (size_t k = 0; k <= count && node != anagram_index::no_node; k++) {
+		if (k > 0 || run > 0) {
+			rest.append(count - k, letter);
+			bool go_on = walk(remaining, runs, run + 1, node, part_size + k, rest,
+					prev_signature, prev_id, ctx);
+			rest.resize(rest_size);
+			if (!go_on) return false;
+		}
+		node = index.child(node, letter);
+	}
+	return true;
+}
+
+bool split_enumerator::for_each(std::string const& signature,
+		split_visitor const& visit) {
+	auto it = memo.find(signature);
+	if (it != memo.end()) {
+		split_list const& list = it->second;
+		uint32_t begin = 0;
+		for (uint32_t end : list.ends) {
+			replay.assign(list.ids.begin() + begin, list.ids.begin() + end);
+			if (!visit(replay)) return false;
+			begin = end;
+		}
+		return true;
+	}
+	split_list found;
+	context ctx = { split(), &found, &visit };
+	if (signature.empty() || !search(signature, -1, no_word, ctx)) {
+		return false;
+	}
+	// a crude bound: when full, forget everything rather than track recency
+	if (memo_words + found.ids.size() > memo_limit) {
+		clear();
+	}
+	memo_words += found.ids.size();
+	split_list& stored = memo[signature];
+	stored.ids.swap(found.ids);
+	stored.ends.swap(found.ends);
+	return true;
+}
+
+bool split_enumerator::for_each(std::string const& letters, char added,
+		split_visitor const& visit) {
+	std::string signature = letters + added;
+	std::sort(signature.begin(), signature.end());
+	return for_each(signature, visit);
+}
+
+std::vector<split> split_enumerator::all(std::string const& signature) {
+	std::vector<split> splits;
+	for_each(signature, [&splits] (split const& s) {
+		splits.push_back(s);
+		return true;
+	});
+	return splits;
+}
@@ -0,0 +1,75 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "anagram_index.hpp"
+#include "lexicon.hpp"
+
+// one way of spelling a letter multiset as words, each at least
+// MIN_WORD_LENGTH long.  Words are ordered by (signature, word_id), so every
+// partition is produced exactly once.
+typedef std::vector<word_id> split;
+
+// return false to stop the enumeration
+typedef std::function<bool (split const&)> split_visitor;
+
+// word IDs the memo may hold before it is dropped and starts over
+#define SPLIT_MEMO_LIMIT (1 << 22)
+
+// enumerates every partition of a letter multiset into valid words, walking
+// the anagram index's trie so that only sub-multisets that spell words are
+// visited.  Results stream to the visitor as the search finds them; a multiset
+// enumerated to completion is remembered, so asking again only replays the
+// stored splits.  Not thread-safe; give each thread its own.
+class split_enumerator {
+	// a multiset's splits, stored flat: split i is ids[ends[i - 1], ends[i])
+	struct split_list {
+		std::vector<word_id> ids;
+		std::vector<uint32_t> ends;
+	};
+
+	anagram_index const& index;
+	std::unordered_map<std::string, split_list> memo;
+	size_t memo_words;
+	size_t memo_limit;
+	split replay;
+
+	struct context {
+		split path;
+		split_list* found;
+		split_visitor const* visit;
+	};
+
+	bool search(std::string const& remaining, int32_t prev_signature,
+			word_id prev_id, context& ctx);
+	bool walk(std::string const& remaining, std::vector<size_t> const& runs,
+			size_t run, uint32_t node, size_t part_size, std::string& rest,
+			int32_t prev_signature, word_id prev_id, context& ctx);
+
+	public:
+	explicit split_enumerator(anagram_index const& index,
+			size_t memo_limit = SPLIT_MEMO_LIMIT)
+		: index(index), memo_words(0), memo_limit(memo_limit) {}
+
+	// signature holds the letters in sorted order.  Returns false if the
+	// visitor stopped the enumeration early.
+	bool for_each(std::string const& signature, split_visitor const& visit);
+	// the splits of letters (any order) plus one added letter
+	bool for_each(std::string const& letters, char added,
+			split_visitor const& visit);
+
+	// every split of signature
+	std::vector<split> all(std::string const& signature);
+
+	size_t memoised() const { return memo.size(); }
+	void clear() {
+		memo.clear();
+		memo_words = 0;
+	}
+};
@@ -0,0 +1,43 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "stem_cache.hpp"
+
+std::vector<stem_id> const* stem_cache::find(std::string const& literal) {
+	if (!enabled) return nullptr;
+	auto it = by_literal.find(literal);
+	if (it == by_literal.end()) {
+		miss_count++;
+		return nullptr;
+	}
+	hit_count++;
+	entries.splice(entries.begin(), entries, it->second);
+	return &it->second->second;
+}
+
+std::vector<stem_id> const& stem_cache::insert(std::string const& literal,
+		std::vector<stem_id> const& stems) {
+	auto it = by_literal.find(literal);
+	if (it != by_literal.end()) {
+		it->second->second = stems;
+		entries.splice(entries.begin(), entries, it->second);
+		return it->second->second;
+	}
+	if (entries.size() >= capacity && !entries.empty()) {
+		by_literal.erase(entries.back().first);
+		entries.pop_back();
+		eviction_count++;
+	}
+	entries.emplace_front(literal, stems);
+	by_literal.emplace(literal, entries.begin());
+	return entries.front().second;
+}
+
+void stem_cache::set_enabled(bool on) {
+	enabled = on;
+	if (!enabled) {
+		entries.clear();
+		by_literal.clear();
+	}
+}
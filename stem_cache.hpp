@@ -0,0 +1,53 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "stem_interner.hpp"
+
+#define STEM_CACHE_CAPACITY 65536
+
+// least recently used cache of stemming results, keyed by lowercase literal.
+// An empty result (not a word) is cached like any other.
+class stem_cache {
+	typedef std::pair<std::string, std::vector<stem_id> > entry;
+
+	size_t capacity;
+	bool enabled;
+	std::list<entry> entries; // most recently used first
+	std::unordered_map<std::string, std::list<entry>::iterator> by_literal;
+	uint64_t hit_count;
+	uint64_t miss_count;
+	uint64_t eviction_count;
+
+	public:
+	explicit stem_cache(size_t capacity = STEM_CACHE_CAPACITY)
+		: capacity(capacity), enabled(true), hit_count(0), miss_count(0),
+		eviction_count(0) {}
+
+	// nullptr on a miss, or always when disabled
+	std::vector<stem_id> const* find(std::string const& literal);
+	std::vector<stem_id> const& insert(std::string const& literal,
+			std::vector<stem_id> const& stems);
+
+	// disabling also drops every entry, so re-enabling starts cold
+	void set_enabled(bool on);
+	bool is_enabled() const { return enabled; }
+
+	size_t size() const { return entries.size(); }
+	uint64_t hits() const { return hit_count; }
+	uint64_t misses() const { return miss_count; }
+	uint64_t evictions() const { return eviction_count; }
+	double hit_rate() const {
+		uint64_t total = hit_count + miss_count;
+		return total == 0 ? 0.0 : static_cast<double>(hit_count) / total;
+	}
+	void reset_counters() { hit_count = miss_count = eviction_count = 0; }
+};
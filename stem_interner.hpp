@@ -0,0 +1,30 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// dense index of a stem; assigned in order of first appearance
+typedef uint32_t stem_id;
+
+class stem_interner {
+	std::unordered_map<std::string, stem_id> ids;
+	std::vector<std::string> names;
+
+	public:
+	stem_id intern(std::string const& stem) {
+		auto it = ids.find(stem);
+		if (it != ids.end()) return it->second;
+		stem_id id = names.size();
+		ids.emplace(stem, id);
+		names.push_back(stem);
+		return id;
+	}
+
+	std::string const& name(stem_id id) const { return names[id]; }
+	size_t size() const { return names.size(); }
+};
@@ -0,0 +1,64 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "stem_interner.hpp"
+
+// set of stem IDs as a bitset, one bit per stem.  Sized up front to the stem
+// count when it is known (the baked table); grows on insert otherwise.
+class stem_set {
+	std::vector<uint64_t> bits;
+
+	public:
+	explicit stem_set(size_t stem_count = 0) : bits((stem_count + 63) / 64) {}
+
+	bool contains(stem_id id) const {
+		size_t i = id / 64;
+		return i < bits.size() && (bits[i] >> (id % 64) & 1) != 0;
+	}
+
+	void insert(stem_id id) {
+		size_t i = id / 64;
+		if (i >= bits.size()) bits.resize(i + 1);
+		bits[i] |= uint64_t(1) << (id % 64);
+	}
+	template<typename It> void insert(It first, It last) {
+		for (; first != last; ++first) {
+			insert(*first);
+		}
+	}
+
+	void erase(stem_id id) {
+		size_t i = id / 64;
+		if (i < bits.size()) bits[i] &= ~(uint64_t(1) << (id % 64));
+	}
+
+	void clear() { std::fill(bits.begin(), bits.end(), 0); }
+
+	size_t size() const {
+		size_t n = 0;
+		for (uint64_t b : bits) {
+			n += __builtin_popcountll(b);
+		}
+		return n;
+	}
+
+	// the raw words, for hashing and serialising
+	std::vector<uint64_t> const& words() const { return bits; }
+	// sets that grew on insert can differ in length; the words past the
+	// shorter one's end have to be empty
+	bool operator== (stem_set const& other) const {
+		std::vector<uint64_t> const& shorter =
+			bits.size() < other.bits.size() ? bits : other.bits;
+		std::vector<uint64_t> const& longer =
+			bits.size() < other.bits.size() ? other.bits : bits;
+		return std::equal(shorter.begin(), shorter.end(), longer.begin()) &&
+			std::all_of(longer.begin() + shorter.size(), longer.end(),
+					[](uint64_t b) { return b == 0; });
+	}
+};
@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include "stem_source.hpp"
+
+stem_source::stem_source(lexicon const& lex, char const* path) : lex(lex) {
+	if (access(path, R_OK) == 0) {
+		baked.reset(new stem_table(lex, path));
+	} else {
+		live.reset(new stemmer(lex));
+	}
+}
+
+stem_range stem_source::stems(std::string const& str) {
+	std::string literal = str;
+	boost::algorithm::to_lower(literal);
+	if (baked) {
+		return baked->stems(lex.find(literal));
+	}
+
+	std::vector<stem_id> const* cached = memo.find(literal);
+	if (cached == nullptr) {
+		uncached.clear();
+		for (auto const& stem : live->stems(literal)) {
+			uncached.push_back(names.intern(stem));
+		}
+		cached = memo.is_enabled() ?
+			&memo.insert(literal, uncached) : &uncached;
+	}
+	stem_range r = { cached->data(), cached->data() + cached->size() };
+	return r;
+}
+
+stem_range stem_source::stems(word_id id) {
+	if (baked) {
+		return baked->stems(id);
+	}
+	if (id == no_word) {
+		stem_range r = { nullptr, nullptr };
+		return r;
+	}
+	return stems(std::string(lex.literal(id), lex.length(id)));
+}
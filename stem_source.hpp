@@ -0,0 +1,42 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "stem_cache.hpp"
+#include "stem_interner.hpp"
+#include "stem_table.hpp"
+#include "stemmer.hpp"
+
+// the engine's view of stems: the baked table when there is one, else the
+// live stemmer behind a cache.  Live stem IDs are dense too, but handed out
+// on first sight, so stem_count() grows as play goes on.
+class stem_source {
+	lexicon const& lex;
+	std::unique_ptr<stem_table> baked;
+	std::unique_ptr<stemmer> live;
+	stem_interner names;
+	stem_cache memo;
+	std::vector<stem_id> uncached;
+
+	public:
+	// loads the baked table from path if it is readable, else WordNet's
+	// morphology
+	stem_source(lexicon const& lex, char const* path = STEMS_SNAPSHOT);
+
+	bool is_baked() const { return static_cast<bool>(baked); }
+	size_t stem_count() const {
+		return baked ? baked->size() : names.size();
+	}
+
+	// empty if str isn't a word.  The range stays valid until the next call.
+	stem_range stems(std::string const& str);
+	stem_range stems(word_id id);
+
+	stem_cache& cache() { return memo; }
+};
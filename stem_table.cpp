@@ -0,0 +1,69 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstring>
+#include <stdexcept>
+
+#include "stem_table.hpp"
+
+stem_table::stem_table(lexicon const& lex, char const* path) : file(path) {
+	if (file.size() < sizeof(stems_header)) {
+		throw std::runtime_error("Stem snapshot is truncated.");
+	}
+	header = reinterpret_cast<stems_header const*>(file.data());
+	if (memcmp(header->magic, STEMS_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a stem snapshot.");
+	}
+	if (header->version != STEMS_VERSION || header->word_count != lex.size()) {
+		throw std::runtime_error(
+				"Stem snapshot doesn't match the lexicon; rebuild it.");
+	}
+	size_t word_offsets_size = (header->word_count + 1) * sizeof(uint32_t);
+	size_t links_size = header->link_count * sizeof(stem_id);
+	size_t name_offsets_size = (header->stem_count + 1) * sizeof(uint32_t);
+	if (file.size() != sizeof(stems_header) + word_offsets_size + links_size +
+			name_offsets_size + header->names_size) {
+		throw std::runtime_error("Stem snapshot is truncated.");
+	}
+	char const* at = file.data() + sizeof(stems_header);
+	word_offsets = reinterpret_cast<uint32_t const*>(at);
+	at += word_offsets_size;
+	links = reinterpret_cast<stem_id const*>(at);
+	at += links_size;
+	name_offsets = reinterpret_cast<uint32_t const*>(at);
+	at += name_offsets_size;
+	names = at;
+}
+
+void stem_table::write_snapshot(std::vector<uint32_t> const& word_offsets,
+		std::vector<stem_id> const& links, std::vector<std::string> const& names,
+		char const* path) {
+	stems_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, STEMS_MAGIC, sizeof(h.magic));
+	h.version = STEMS_VERSION;
+	h.word_count = word_offsets.size() - 1;
+	h.stem_count = names.size();
+	h.link_count = links.size();
+
+	std::vector<uint32_t> name_offsets;
+	std::string blob;
+	for (auto const& n : names) {
+		name_offsets.push_back(blob.size());
+		blob += n;
+		blob += '\0';
+	}
+	name_offsets.push_back(blob.size());
+	h.names_size = blob.size();
+
+	std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+	out.append(reinterpret_cast<char const*>(word_offsets.data()),
+			word_offsets.size() * sizeof(uint32_t));
+	out.append(reinterpret_cast<char const*>(links.data()),
+			links.size() * sizeof(stem_id));
+	out.append(reinterpret_cast<char const*>(name_offsets.data()),
+			name_offsets.size() * sizeof(uint32_t));
+	out += blob;
+	write_file_atomic(path, out.data(), out.size());
+}
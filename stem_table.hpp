@@ -0,0 +1,62 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "mapped_file.hpp"
+#include "stem_interner.hpp"
+
+#define STEMS_SNAPSHOT "stems.bin"
+#define STEMS_MAGIC "RTP-STM"
+#define STEMS_VERSION 2
+
+typedef id_range<stem_id> stem_range;
+
+// on-disk layout: header, word_count + 1 offsets into the links, the links
+// (stem IDs), stem_count + 1 offsets into the names, then the names blob of
+// NUL-terminated stems
+struct stems_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+	uint32_t stem_count;
+	uint32_t link_count;
+	uint32_t names_size;
+	uint32_t reserved;
+};
+
+// every lexicon word's stems, precomputed by build_stems so that the game
+// needs neither WordNet nor Hunspell at runtime
+class stem_table {
+	mapped_file file;
+	stems_header const* header;
+	uint32_t const* word_offsets;
+	stem_id const* links;
+	uint32_t const* name_offsets;
+	char const* names;
+
+	public:
+	stem_table(lexicon const& lex, char const* path = STEMS_SNAPSHOT);
+
+	size_t size() const { return header->stem_count; }
+	char const* name(stem_id id) const { return names + name_offsets[id]; }
+	// empty for no_word, and for words that didn't stem
+	stem_range stems(word_id id) const {
+		if (id == no_word) {
+			stem_range r = { links, links };
+			return r;
+		}
+		stem_range r = { links + word_offsets[id], links + word_offsets[id + 1] };
+		return r;
+	}
+
+	// word_offsets must hold word_count + 1 entries indexing into links
+	static void write_snapshot(std::vector<uint32_t> const& word_offsets,
+			std::vector<stem_id> const& links,
+			std::vector<std::string> const& names, char const* path);
+};
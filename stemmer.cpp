@@ -0,0 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdexcept>
+
+#include "stemmer.hpp"
+
+// longest word stemmed, as WordNet's own buffers once limited it
+#define STEMMER_MAX_LENGTH 127
+
+stemmer::stemmer(lexicon const& lex) : lex(lex) {
+}
+
+std::set<std::string> stemmer::stems(std::string const& str) {
+	std::set<std::string> stems;
+
+	if (str.size() > STEMMER_MAX_LENGTH) {
+		throw std::runtime_error("Input length exceeded.");
+	}
+
+	std::string literal = str;
+	if (!lowercase_and_validate(literal) || !lex.contains(literal)) {
+		return stems;
+	}
+
+	bool should_hunspell = false;
+
+	// morph the str to base form first
+	std::string base;
+	for (int i = noun; i < parts_of_speech; i++) {
+		part_of_speech pos = static_cast<part_of_speech>(i);
+		// if already base form, be sure to check with hunspell before adding
+		if (!morph.base_form(literal, pos, base)) {
+			if (morph.defined(literal, pos)) {
+				should_hunspell = true;
+			}
+			continue;
+		}
+		stems.insert(base);
+	}
+
+	// then try stemming it
+	if (should_hunspell) {
+		spell_pool::checker hunspell(spell);
+		std::vector<std::string> found = hunspell.stems(literal.c_str());
+		stems.insert(found.begin(), found.end());
+	}
+
+	return stems;
+}
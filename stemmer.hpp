@@ -0,0 +1,27 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <set>
+#include <string>
+
+#include "lexicon.hpp"
+#include "morphology.hpp"
+#include "spell_pool.hpp"
+
+// reduces words to their base forms with WordNet's morphology, falling back to
+// Hunspell's stemmer for words WordNet already considers base forms.  Needs the
+// WordNet database.  Any number of threads may stem at once.
+class stemmer {
+	lexicon const& lex;
+	morphology morph;
+	// only needed for some words, so handles load on first use
+	spell_pool spell;
+
+	public:
+	explicit stemmer(lexicon const& lex);
+
+	// empty if str isn't a word
+	std::set<std::string> stems(std::string const& str);
+};
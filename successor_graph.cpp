@@ -0,0 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "successor_graph.hpp"
+
+successor_graph::successor_graph(lexicon const& lex, char const* path)
+		: file(path) {
+	if (file.size() < sizeof(successors_header)) {
+		throw std::runtime_error("Successor snapshot is truncated.");
+	}
+	header = reinterpret_cast<successors_header const*>(file.data());
+	if (memcmp(header->magic, SUCCESSORS_MAGIC, sizeof(header->magic)) != 0) {
+		throw std::runtime_error("Not a successor snapshot.");
+	}
+	if (header->version != SUCCESSORS_VERSION ||
+			header->word_count != lex.size()) {
+		throw std::runtime_error(
+				"Successor snapshot doesn't match the lexicon; rebuild it.");
+	}
+	size_t offsets_size = (header->word_count + 1) * sizeof(uint32_t);
+	if (file.size() != sizeof(successors_header) + offsets_size +
+			header->edge_count * sizeof(word_id)) {
+		throw std::runtime_error("Successor snapshot is truncated.");
+	}
+	offsets = reinterpret_cast<uint32_t const*>(file.data() +
+			sizeof(successors_header));
+	targets = reinterpret_cast<word_id const*>(file.data() +
+			sizeof(successors_header) + offsets_size);
+}
+
+void successor_graph::write_snapshot(std::vector<uint32_t> const& offsets,
+		std::vector<word_id> const& targets, char const* path) {
+	successors_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, SUCCESSORS_MAGIC, sizeof(h.magic));
+	h.version = SUCCESSORS_VERSION;
+	h.word_count = offsets.size() - 1;
+	h.edge_count = targets.size();
+
+	std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+	out.append(reinterpret_cast<char const*>(offsets.data()),
+			offsets.size() * sizeof(uint32_t));
+	out.append(reinterpret_cast<char const*>(targets.data()),
+			targets.size() * sizeof(word_id));
+	write_file_atomic(path, out.data(), out.size());
+}
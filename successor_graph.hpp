@@ -0,0 +1,48 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cstdint>
+#include <vector>
+
+#include "lexicon.hpp"
+#include "mapped_file.hpp"
+
+#define SUCCESSORS_SNAPSHOT "successors.bin"
+#define SUCCESSORS_MAGIC "RTP-SUC"
+#define SUCCESSORS_VERSION 1
+
+// on-disk layout: header, word_count + 1 row offsets, then edge_count targets
+struct successors_header {
+	char magic[8];
+	uint32_t version;
+	uint32_t word_count;
+	uint32_t edge_count;
+	uint32_t reserved;
+};
+
+// for each lexicon word, every single word reachable by adding one letter and
+// anagramming, as a compressed sparse row array mapped from build_successors'
+// snapshot.  A row lists its words as anagram_index::successors() does.  Move
+// generation reads single-word moves from here rather than looking up
+// anagram signatures at play time.
+class successor_graph {
+	mapped_file file;
+	successors_header const* header;
+	uint32_t const* offsets;
+	word_id const* targets;
+
+	public:
+	successor_graph(lexicon const& lex, char const* path = SUCCESSORS_SNAPSHOT);
+
+	size_t edge_count() const { return header->edge_count; }
+	word_range successors(word_id id) const {
+		word_range r = { targets + offsets[id], targets + offsets[id + 1] };
+		return r;
+	}
+
+	// offsets must hold word_count + 1 entries indexing into targets
+	static void write_snapshot(std::vector<uint32_t> const& offsets,
+			std::vector<word_id> const& targets, char const* path);
+};
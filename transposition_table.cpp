@@ -0,0 +1,59 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "transposition_table.hpp"
+
+// entry data: the score above the depth.  Depth is stored plus one, so an
+// empty entry's data is zero.
+#define DEPTH_BITS 24
+#define DEPTH_MASK ((uint64_t(1) << DEPTH_BITS) - 1)
+
+transposition_table::transposition_table(size_t bytes, replacement policy)
+	: policy(policy) {
+	size_t count = 2;
+	while (count * 2 * sizeof(entry) <= bytes) count *= 2;
+	entries.reset(new entry[count]);
+	mask = count - 1;
+	clear();
+}
+
+bool transposition_table::improves(uint64_t key, unsigned long score,
+		size_t depth) {
+	uint64_t stored_depth = depth + 1 < DEPTH_MASK ? depth + 1 : DEPTH_MASK;
+	uint64_t data = (uint64_t(score) << DEPTH_BITS) | stored_depth;
+
+	// always: one slot per key.  depth_preferred: a bucket of two, the first
+	// kept for the shallowest state.
+	size_t slot = key & mask;
+	size_t slots = 1;
+	if (policy == replacement::depth_preferred) {
+		slot &= ~size_t(1);
+		slots = 2;
+	}
+
+	entry* victim = &entries[slot + slots - 1];
+	for (size_t i = 0; i < slots; i++) {
+		entry& e = entries[slot + i];
+		uint64_t d = e.data.load(std::memory_order_relaxed);
+		uint64_t c = e.check.load(std::memory_order_relaxed);
+		if (d != 0 && (c ^ d) == key) {
+			if ((d >> DEPTH_BITS) >= score) return false;
+			victim = &e;
+			break;
+		}
+		if (i == 0 && (d == 0 || stored_depth <= (d & DEPTH_MASK))) {
+			victim = &e;
+		}
+	}
+	victim->data.store(data, std::memory_order_relaxed);
+	victim->check.store(key ^ data, std::memory_order_relaxed);
+	return true;
+}
+
+void transposition_table::clear() {
+	for (size_t i = 0; i <= mask; i++) {
+		entries[i].check.store(0, std::memory_order_relaxed);
+		entries[i].data.store(0, std::memory_order_relaxed);
+	}
+}
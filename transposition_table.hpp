@@ -0,0 +1,67 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "lexicon.hpp"
+#include "stem_interner.hpp"
+
+// splitmix64's finaliser: a well-mixed 64-bit key from a counter
+inline uint64_t zobrist_mix(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+// a pseudo-random 64-bit key per word and per stem.  A position's hash is the
+// XOR of the keys of its current words and used stems, so a move updates it
+// by XORing in the keys of what it adds and removes, and undoing the move is
+// the same XOR again.  Keys are computed rather than tabled because live stem
+// IDs are handed out as play goes on.
+inline uint64_t zobrist_word(word_id id) {
+	return zobrist_mix(uint64_t(id) << 1);
+}
+inline uint64_t zobrist_stem(stem_id id) {
+	return zobrist_mix((uint64_t(id) << 1) | 1);
+}
+
+enum class replacement {
+	// a new state always takes its slot
+	always,
+	// each bucket keeps the shallowest state it has seen, whose subtree is the
+	// biggest, in one slot and the latest in the other
+	depth_preferred
+};
+
+// the best score each search state has been reached with, in a fixed amount
+// of memory.  Lock-free: an entry is two words, the data and the key XORed
+// with the data, so a torn read from a racing write fails the key check and
+// reads as a miss.  Safe to share between threads.
+class transposition_table {
+	struct entry {
+		std::atomic<uint64_t> check;
+		std::atomic<uint64_t> data;
+	};
+
+	std::unique_ptr<entry[]> entries;
+	size_t mask;
+	replacement policy;
+
+	public:
+	// uses the largest power of two entries that fit in bytes
+	transposition_table(size_t bytes, replacement policy);
+
+	// false if the state key has already been reached with at least score;
+	// otherwise records score and returns true.  depth is how many moves in
+	// the state is, for the replacement policy.
+	bool improves(uint64_t key, unsigned long score, size_t depth);
+
+	void clear();
+	size_t capacity() const { return mask + 1; }
+};
@@ -0,0 +1,68 @@
+#pragma once
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <vector>
+
+#include "lexicon.hpp"
+
+// set of word IDs as a sorted vector.  Lexicon IDs are numbered in sorted
+// order, so iterating yields the words alphabetically, as std::set<word> did.
+// A game holds a few dozen words at most, so shifting on insert and erase is
+// cheaper than a node allocation, and copying the state is one memcpy.
+class word_set {
+	std::vector<word_id> ids;
+
+	public:
+	typedef std::vector<word_id>::const_iterator const_iterator;
+
+	const_iterator begin() const { return ids.begin(); }
+	const_iterator end() const { return ids.end(); }
+	size_t size() const { return ids.size(); }
+	bool empty() const { return ids.empty(); }
+
+	const_iterator find(word_id id) const {
+		const_iterator it = std::lower_bound(ids.begin(), ids.end(), id);
+		return it != ids.end() && *it == id ? it : ids.end();
+	}
+	bool contains(word_id id) const { return find(id) != ids.end(); }
+
+	// false if id was already there
+	bool insert(word_id id) {
+		auto it = std::lower_bound(ids.begin(), ids.end(), id);
+		if (it != ids.end() && *it == id) return false;
+		ids.insert(it, id);
+		return true;
+	}
+	template<typename It> void insert(It first, It last) {
+		for (; first != last; ++first) {
+			insert(*first);
+		}
+	}
+
+	void erase(const_iterator it) {
+		ids.erase(it);
+	}
+	// false if id wasn't there
+	bool erase(word_id id) {
+		const_iterator it = find(id);
+		if (it == ids.end()) return false;
+		erase(it);
+		return true;
+	}
+
+	void clear() { ids.clear(); }
+
+	// calls f with each ID, in increasing order, as persistent_bitset does
+	template<typename F> void for_each(F f) const {
+		for (word_id id : ids) {
+			f(id);
+		}
+	}
+
+	// the raw IDs, in order, for the searches and for serialising
+	std::vector<word_id> const& words() const { return ids; }
+	bool operator== (word_set const& other) const { return ids == other.ids; }
+};